@@ -0,0 +1,78 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/*
+ * IniClient
+ * Looks keys up in an IniServer over its unix domain socket.
+ */
+class IniClient
+{
+public: // types
+    // the answer to a query
+    struct Answer {
+        bool bFound;
+        string strValue;
+    };
+
+public: // methods
+    /*
+     * constructor - connects to the server
+     * @param strSocketPath - the path of the unix domain socket
+     * @throws invalid_argument - if the path is too long
+     * @throws runtime_error - if the server cannot be reached
+     */
+    IniClient(const string& strSocketPath);
+
+    /*
+     * delete copy constructor
+     */
+    IniClient(const IniClient& other) = delete;
+
+    /*
+     * delete copy assignment operator
+     */
+    IniClient& operator=(const IniClient& other) = delete;
+
+    /*
+     * destructor - closes the connection
+     */
+    ~IniClient();
+
+    /*
+     * looks a batch of keys up - requests are pipelined and answers are read while requests are still sent,
+     * so a batch costs a few round trips only and never waits on a server waiting on this client
+     * @param keys - the keys, qualified by their sections as "section.key"
+     * @param answers - receives one answer per key, in the same order
+     * @throws invalid_argument - if a key is too long, nothing is sent then
+     * @throws runtime_error - if the connection breaks
+     */
+    void query(const vector<string>& keys, vector<Answer>& answers);
+
+private: // methods
+    /*
+     * reads the bytes available
+     * @throws runtime_error - if the connection breaks
+     */
+    void receive();
+
+    /*
+     * takes an answer out of the bytes received
+     * @param answer - receives the answer
+     * @return false if the answer is not complete yet
+     */
+    bool takeAnswer(Answer& answer);
+
+private: // attributes
+    // holds the connected socket
+    int m_nFd;
+
+    // holds the bytes received
+    string m_strIn;
+
+    // holds the offset of the first byte not consumed yet
+    size_t m_nInOffset;
+};
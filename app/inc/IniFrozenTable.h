@@ -0,0 +1,167 @@
+#pragma once
+
+#include <string>
+#include <map>
+#include <vector>
+#include <cstdint>
+
+#include "IniStringPool.h"
+
+using namespace std;
+
+/*
+ * IniFrozenTable
+ * Immutable, read-only representation of the values loaded by an IniParser.
+ * Keys and values are packed into a single contiguous string pool and indexed by a
+ * minimal perfect hash, so a lookup costs one hash, one probe and one key compare.
+ */
+class IniFrozenTable
+{
+public: // methods
+    /*
+     * constructor - builds an empty table
+     */
+    IniFrozenTable();
+
+    /*
+     * rebuilds the table from the given key-value pairs
+     * @param values - the key-value pairs; keys are already qualified by their section
+     * @throws runtime_error - if the table cannot hold that many values
+     */
+    void build(const IniValues& values);
+
+    /*
+     * copies the key-value pairs held by the table back into a map
+     * @param values - the map receiving the key-value pairs
+     */
+    void extract(IniValues& values) const;
+
+    /*
+     * looks up the value associated to a key under a section
+     * @param strKey - specifies the key to look after
+     * @param strSection - specifies the section to look after, empty for no section
+     * @param strValue - receives the value, untouched if the key is missing
+     * @return true if the key was found
+     */
+    bool find(const string& strKey, const string& strSection, string& strValue) const;
+
+    /*
+     * @return the number of bytes of the image of the table
+     */
+    size_t imageSize() const;
+
+    /*
+     * writes the table as a position independent image - offsets only, no pointers
+     * so it can be looked up in place wherever it is mapped
+     * @param pImage - receives imageSize() bytes, aligned to 8 bytes
+     */
+    void writeImage(char* pImage) const;
+
+    /*
+     * checks that an image is consistent before looking keys up in it
+     * @param pImage - the image, aligned to 8 bytes
+     * @param nSize - the number of bytes available
+     * @return true if every offset of the image stays within the given bytes
+     */
+    static bool isImage(const char* pImage, size_t nSize);
+
+    /*
+     * looks up the value associated to a key in an image written by writeImage
+     * @param pImage - the image, checked by isImage
+     * @param strKey - specifies the key to look after
+     * @param strSection - specifies the section to look after, empty for no section
+     * @param strValue - receives the value, untouched if the key is missing
+     * @return true if the key was found
+     */
+    static bool find(const char* pImage, const string& strKey, const string& strSection, string& strValue);
+
+    /*
+     * @return the number of values stored in the table
+     */
+    size_t size() const;
+
+    /*
+     * releases all the values held by the table
+     */
+    void clear();
+
+private: // types
+    // a slot of the table, pointing into the string pool
+    // the value is stored right after the key
+    struct Entry {
+        uint64_t nOffset;
+        uint32_t nKeyLength;
+        uint32_t nValueLength;
+    };
+
+    // the header of an image, followed by the displacements, the entries and the pool
+    struct ImageHeader {
+        uint64_t nSeed;
+        uint64_t nBuckets;
+        uint64_t nEntries;
+        uint64_t nPoolSize;
+    };
+
+    // the parts of a table, either held by the table or found in an image
+    struct View {
+        uint64_t        nSeed;
+        const uint32_t* pDisplacements;
+        size_t          nBuckets;
+        const Entry*    pEntries;
+        size_t          nEntries;
+        const char*     pPool;
+    };
+
+private: // methods
+    /*
+     * looks up the value associated to a key in the parts of a table
+     */
+    static bool find(const View& view, const string& strKey, const string& strSection, string& strValue);
+
+    /*
+     * @return the offset of the entries in an image, after the displacements
+     */
+    static size_t entriesOffset(size_t nBuckets);
+
+    /*
+     * hashes the qualified key "section.key" without building it
+     * @param pKey - the characters of the key
+     * @param nKeyLength - the number of characters of the key
+     * @param strSection - the section, empty for no section
+     * @param nSeed - the seed of the hash function
+     * @return a well mixed 64 bits hash
+     */
+    static uint64_t hash(const char* pKey, size_t nKeyLength, const string& strSection, uint64_t nSeed);
+
+    /*
+     * derives the slot of a key from its hash and the displacement of its bucket
+     * @param nHash - the hash of the key
+     * @param nDisplacement - the displacement of the bucket the key belongs to
+     * @param nEntries - the number of slots
+     * @return the slot index
+     */
+    static size_t slot(uint64_t nHash, uint32_t nDisplacement, size_t nEntries);
+
+    /*
+     * tries to build the perfect hash with the given seed
+     * @param keys - the qualified keys
+     * @param nSeed - the seed of the hash function
+     * @param slots - receives the slot assigned to each key
+     * @return true if every bucket could be placed
+     */
+    bool place(const vector<const IniString*>& keys, uint64_t nSeed, vector<size_t>& slots);
+
+private: // attributes
+    // holds the seed the perfect hash was built with
+    uint64_t m_nSeed;
+
+    // holds one displacement per bucket
+    // the high bit marks buckets with a single key, stored directly at the slot in the low bits
+    vector<uint32_t> m_displacements;
+
+    // holds one entry per value, indexed by the perfect hash
+    vector<Entry> m_entries;
+
+    // holds all the keys and values, back to back
+    string m_strPool;
+};
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <istream>
+#include <streambuf>
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+using namespace std;
+
+/*
+ * IniGzipStreamBuf
+ * Input stream buffer that inflates a gzip compressed stream on a background thread.
+ * The compressed input is read and inflated in bounded-size chunks handed over through a bounded queue,
+ * so decompression overlaps with parsing and memory use does not depend on the input size.
+ */
+class IniGzipStreamBuf : public streambuf
+{
+public: // methods
+    /*
+     * constructor - starts the decompression thread
+     * @param source - the compressed input, it must outlive this object
+     */
+    IniGzipStreamBuf(istream& source);
+
+    /*
+     * delete copy constructor
+     */
+    IniGzipStreamBuf(const IniGzipStreamBuf& other) = delete;
+
+    /*
+     * delete copy assignment operator
+     */
+    IniGzipStreamBuf& operator=(const IniGzipStreamBuf& other) = delete;
+
+    /*
+     * destructor - stops and joins the decompression thread
+     */
+    ~IniGzipStreamBuf();
+
+    /*
+     * checks the gzip magic number without consuming any input
+     * @param source - the input to check
+     * @return true if the input starts like a gzip stream
+     */
+    static bool isGzip(istream& source);
+
+    /*
+     * @return an empty string if the decompression went fine so far, the error message otherwise
+     */
+    string error() const;
+
+protected: // methods
+    /*
+     * refills the get area with the next inflated chunk, waiting for it if needed
+     * @return the next character or eof once the whole input was inflated
+     */
+    int_type underflow() override;
+
+private: // methods
+    /*
+     * the body of the decompression thread
+     */
+    void inflateAll();
+
+    /*
+     * hands an inflated chunk over to the parsing thread, waiting for room in the queue
+     * @param chunk - the chunk, swapped with a recycled one
+     * @return false if the stream buffer is being destroyed
+     */
+    bool push(vector<char>& chunk);
+
+private: // attributes
+    // holds the compressed input
+    istream& m_source;
+
+    // holds the chunk currently exposed as get area
+    vector<char> m_current;
+
+    // holds the inflated chunks not consumed yet
+    deque<vector<char>> m_filled;
+
+    // holds consumed chunks, recycled by the decompression thread
+    deque<vector<char>> m_free;
+
+    // set once the decompression thread is done, either at the end of the input or on error
+    bool m_bDone;
+
+    // set when the stream buffer is destroyed before the whole input was consumed
+    bool m_bStop;
+
+    // holds the error message, if any
+    string m_strError;
+
+    // guards the queues, the flags and the error message
+    mutable mutex m_mutex;
+
+    // signals changes of the queues and of the flags
+    condition_variable m_condition;
+
+    // holds the decompression thread
+    thread m_thread;
+};
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <string>
+#include <set>
+#include <vector>
+#include <functional>
+
+using namespace std;
+
+/*
+ * IniLoadFilter
+ * Selects the sections and keys an IniParser keeps while loading files.
+ * A section is kept if it is allowed explicitly, if the predicate accepts it, or if a key prefix may match its keys.
+ * An empty filter keeps everything.
+ */
+class IniLoadFilter
+{
+public: // methods
+    /*
+     * constructor - builds a filter that keeps everything
+     */
+    IniLoadFilter();
+
+    /*
+     * keeps all the keys of a section
+     * @param strSection - the section, empty for the keys outside any section
+     * @return the filter, so calls can be chained
+     */
+    IniLoadFilter& addSection(const string& strSection);
+
+    /*
+     * keeps the keys whose qualified name "section.key" starts with a prefix
+     * @param strPrefix - the prefix
+     * @return the filter, so calls can be chained
+     */
+    IniLoadFilter& addKeyPrefix(const string& strPrefix);
+
+    /*
+     * keeps all the keys of the sections accepted by a predicate
+     * @param predicate - called with the section name, empty for the keys outside any section
+     * @return the filter, so calls can be chained
+     */
+    IniLoadFilter& setSectionPredicate(const function<bool(const string&)>& predicate);
+
+    /*
+     * @return true if the filter keeps everything
+     */
+    bool empty() const;
+
+    /*
+     * checks if any key of a section may be kept - called once per section header
+     * @param strSection - the section, empty for the keys outside any section
+     * @return false if the whole section can be skipped
+     */
+    bool acceptsSection(const string& strSection) const;
+
+    /*
+     * checks if all the keys of a section are kept - called once per section header
+     * @param strSection - the section, empty for the keys outside any section
+     * @return true if the keys of the section don't need to be checked one by one
+     */
+    bool acceptsWholeSection(const string& strSection) const;
+
+    /*
+     * checks if a key of a section that is not kept as a whole is kept
+     * @param strQualifiedKey - the key, qualified by its section
+     * @return true if the key matches a prefix
+     */
+    bool acceptsKey(const string& strQualifiedKey) const;
+
+private: // attributes
+    // holds the sections kept as a whole
+    set<string> m_sections;
+
+    // holds the prefixes of the qualified keys kept
+    vector<string> m_keyPrefixes;
+
+    // holds the predicate selecting the sections kept as a whole, empty if none
+    function<bool(const string&)> m_sectionPredicate;
+};
@@ -3,6 +3,14 @@
 #include <string>
 #include <map>
 #include <regex>
+#include <vector>
+#include <set>
+
+#include "IniFrozenTable.h"
+#include "IniStringPool.h"
+#include "IniLoadFilter.h"
+
+class IniWriter;
 
 using namespace std;
 
@@ -12,6 +20,26 @@ using namespace std;
  */
 class IniParser
 {
+public: // types
+    /*
+     * a change of a single key, as computed by diff
+     */
+    struct change
+    {
+        enum type_t { added, removed, changed };
+
+        // holds the kind of change
+        type_t type;
+
+        // holds the key, qualified by its section
+        IniString key;
+
+        // holds the new value, empty for removed keys
+        IniString value;
+    };
+
+    typedef vector<change> change_set;
+
 public: // methods
     /*
      * constructor
@@ -53,14 +81,18 @@ public: // methods
 
     /*
      * updates the internal representation by appending the values from the ini file
+     * gzip compressed files are detected and inflated on the fly
      * @param strFileName - specifies the path to the ini file
      * @throws invalid_argument - if the path is invalid
 	 *                            it won't change the object - strong guarantee
+     * @throws logic_error - if the parser is frozen
+	 *                       it won't change the object - strong guarantee
      * @throws invalid_format_exception - if the parser matches an invalid line
-	 *                                    it leaves the object in consistent state - basic guarantee
+	 *                                    it won't change the object - strong guarantee
      * @throws runtime_error - if the parser cannot load values anymore due to memory or some other limitations
-	 *                         it leaves the object in consistent state - basic guarantee
-	 * @return 0 for success and negative value for error
+     *                         or if a gzip compressed file is corrupted or truncated
+	 *                         it won't change the object - strong guarantee
+	 * @return 0 for success and negative value for error, the object is not changed on error
      */         
     int updateFromFile(const string& strFileName);
     
@@ -75,10 +107,102 @@ public: // methods
 	size_t max_size() const;
     
     /*
-     * clears all the values stored so far
+     * clears all the values stored so far and unfreezes the parser
      */
     void clear();
+
+    /*
+     * moves the values stored so far into an immutable table indexed by a minimal perfect hash
+     * lookups get faster, updates are rejected until the parser is unfrozen or cleared
+     * @throws runtime_error - if the table cannot be built, it won't change the object - strong guarantee
+     */
+    void freeze();
+
+    /*
+     * moves the values back from the immutable table, so the parser accepts updates again
+     */
+    void unfreeze();
+
+    /*
+     * @return true if the parser is frozen
+     */
+    bool isFrozen() const;
+
+    /*
+     * stores the keys and values into a pool shared with other parsers, so identical strings are stored once
+     * the values stored so far are moved into the pool as well
+     * @param stringPool - the pool, null to stop pooling the values loaded from now on
+     */
+    void setStringPool(const shared_ptr<IniStringPool>& stringPool);
+
+    /*
+     * selects the sections and keys kept by the files loaded from now on
+     * the lines of the sections that are not kept are skipped without being classified,
+     * so invalid lines are not reported there
+     * @param loadFilter - the filter, an empty filter keeps everything
+     */
+    void setLoadFilter(const IniLoadFilter& loadFilter);
       
+    /*
+     * adds or overwrites a value, the edit is remembered for writeToFile
+     * @param strKey - specifies the key
+     * @param strValue - specifies the value, the spaces around it are trimmed as when loading
+     * @param strSection - specifies the section, empty for no section
+     * @throws invalid_argument - if the key, the value or the section cannot be written into an ini file
+     * @throws logic_error - if the parser is frozen
+     */
+    void setValue(const string& strKey, const string& strValue, const string& strSection = "");
+
+    /*
+     * removes a value, the edit is remembered for writeToFile
+     * @param strKey - specifies the key
+     * @param strSection - specifies the section, empty for no section
+     * @throws logic_error - if the parser is frozen
+     * @return true if the key was there
+     */
+    bool removeKey(const string& strKey, const string& strSection = "");
+
+    /*
+     * writes all the values into a new ini file, keys without section first, then one block per section
+     * the file is replaced atomically and keeps its permissions
+     * @param strFileName - specifies the path to the ini file
+     * @throws invalid_argument - if the file cannot be created
+     * @throws logic_error - if the parser is frozen
+     * @throws runtime_error - if the file cannot be written
+     */
+    void writeToFile(const string& strFileName) const;
+
+    /*
+     * writes a source ini file with the edits made by setValue, removeKey and apply since the parser was cleared
+     * untouched bytes are copied straight from the source, so comments, ordering and blank lines are kept;
+     * edited keys are rewritten in place, removed keys are dropped, new keys go at the end of their section
+     * the file is replaced atomically, so the source may be the output as well, and gets the permissions of the source
+     * @param strFileName - specifies the path to the ini file
+     * @param strSourceFile - specifies the path to the source ini file, not compressed
+     * @throws invalid_argument - if a file cannot be opened or created
+     * @throws logic_error - if the parser is frozen
+     * @throws runtime_error - if the file cannot be written
+     */
+    void writeToFile(const string& strFileName, const string& strSourceFile) const;
+
+    /*
+     * computes the changes turning one parser into another, in a single pass over both
+     * @param from - the parser before the changes
+     * @param to - the parser after the changes
+     * @throws logic_error - if any of the parsers is frozen
+     * @return the changes, sorted by key
+     */
+    static change_set diff(const IniParser& from, const IniParser& to);
+
+    /*
+     * updates the values in place with a set of changes
+     * removing a missing key is ignored, changing a missing key adds it
+     * @param changes - the changes, applied in order; sorted by key as returned by diff is the fastest
+     * @throws logic_error - if the parser is frozen, it won't change the object - strong guarantee
+     * @throws runtime_error - if the parser cannot store values anymore, it leaves the object in consistent state - basic guarantee
+     */
+    void apply(const change_set& changes);
+
     /*
      * gets the value associated to a specific key under a specific section
      * @param strKey - specifies key to look after
@@ -123,15 +247,23 @@ private: // methods
      * @param strSection - specifies section to look after
      * @throws invalid_argument - if the key is empty
      * @throws no_such_key_exception - if there is no value for the specified key
-     * @return const reference to the value in string format
+     * @return the value in string format
      */
-    const string& getValue(const string& strKey, const string& section = "") const;
+    string getValue(const string& strKey, const string& section = "") const;
 
     /*
-     * updates the internal representation by adding/updating a key
+     * stages a key value assigment, to be merged into the internal representation once the file is parsed
      * @param strKeyValueAssigment - a string that matches a key value assigment regex
+     * @param staged - receives the qualified key and the value
      */
-    void handleKeyValueAssigment(const string& strKeyValueAssigment);
+    void handleKeyValueAssigment(const string& strKeyValueAssigment, vector<pair<string, string>>& staged);
+
+    /*
+     * updates the internal representation by adding/updating the staged keys, the last writer wins
+     * @param staged - the staged keys and values, in file order
+     * @throws runtime_error - if the parser cannot store values anymore, it won't change the object - strong guarantee
+     */
+    void mergeStaged(const vector<pair<string, string>>& staged);
     
     /*
      * updates the internal representation by adding/updating a key
@@ -139,12 +271,57 @@ private: // methods
      */
     void handleSection(const string& strSection);
 
+    /*
+     * checks the current section against the load filter
+     */
+    void filterSection();
+
+    /*
+     * skips the leading spaces of the next line and checks if it may be a section header
+     * @param is - the input stream
+     * @return true if the next line starts with a section start operator
+     */
+    bool peekSection(istream& is);
+
+    /*
+     * builds a handle for a key or a value, taking it from the string pool if there is one
+     * @param s - the characters
+     * @return the handle
+     */
+    IniString intern(const string& s) const;
+
+    /*
+     * shares a key or a value coming from another parser, moving it into the string pool if there is one
+     * @param s - the handle
+     * @return the handle
+     */
+    IniString intern(const IniString& s) const;
+
+    /*
+     * moves the values stored so far into the string pool, if there is one
+     */
+    void internValues();
+
+    /*
+     * remembers the edit of a key for writeToFile
+     * @param strQualifiedKey - the key, qualified by its section
+     */
+    void recordEdit(const string& strQualifiedKey);
+
+    /*
+     * writes a source ini file with the edits applied
+     * @param writer - the output
+     * @param pSource - the bytes of the source file
+     * @param nSize - the number of bytes
+     */
+    void writeEdits(IniWriter& writer, const char* pSource, size_t nSize) const;
+
     /*
      * eliminates the spaces from the beginning and from the ending of a string
      * @param s - a string
      * @return - a new trimmed string
      */
-    string trim(const string& s);  
+    static string trim(const string& s);  
 
     // logging: tipically, a more robust and configurable logging system is used in production
     // this is just a lazy way to log some text in the standard log/standard error
@@ -166,6 +343,9 @@ private: // methods
      */
     void logError(const string& strError);
 
+    // publishes the frozen table into shared memory
+    friend class IniSharedPublisher;
+
 private: // attributes
     // holds the skip invalid lines mode of operation
     bool m_bSkipInvalidLines;
@@ -174,9 +354,30 @@ private: // attributes
     // it won't span across multiple files.
     string m_strCurrentSection;
 
+    // holds the sections and keys kept while loading files
+    IniLoadFilter m_loadFilter;
+
+    // set while parsing a section that is not kept
+    bool m_bSkipSection;
+
+    // set while parsing a section that is kept as a whole, so keys are not checked one by one
+    bool m_bKeepSection;
+
 	// the internal representatin of an ini file
     // holds the key-value pairs
-    map<string, string> m_values;
+    IniValues m_values;
+
+    // holds the keys edited since the parser was cleared, by section
+    map<string, set<string>> m_edits;
+
+    // holds the pool shared with other parsers, null if the strings are not pooled
+    shared_ptr<IniStringPool> m_stringPool;
+
+    // holds the values once the parser is frozen, m_values is empty meanwhile
+    IniFrozenTable m_frozenValues;
+
+    // holds the frozen state
+    bool m_bFrozen;
 
     // holds a regex that matches the comments into an ini file    
     regex m_regexComment; 
@@ -187,3 +388,10 @@ private: // attributes
     // holds a regex that matches the key value assigments into an ini file
     regex m_regexKeyValueAssigment;
 };
+
+// specialisations of the template getter, defined in IniParserT.cpp
+template <>
+string IniParser::getValueT(const string& strKey, const string& strSection) const;
+
+template <>
+bool IniParser::getValueT(const string& strKey, const string& strSection) const;
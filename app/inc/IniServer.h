@@ -0,0 +1,128 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstdint>
+
+#include "IniParser.h"
+
+using namespace std;
+
+// the protocol spoken over the unix domain socket, in host byte order
+// request:  uint32 length, the qualified key "section.key"
+// response: uint8 status, uint32 length, the value
+#define INI_PROTOCOL_FOUND          0
+#define INI_PROTOCOL_NO_SUCH_KEY    1
+#define INI_PROTOCOL_MAX_REQUEST    (64 * 1024)
+
+/*
+ * IniServer
+ * Loads a set of ini files once and answers lookups over a unix domain socket.
+ * A single thread serves all the clients; requests may be pipelined and are answered in order,
+ * all the requests found in a read are answered with a single write.
+ */
+class IniServer
+{
+public: // methods
+    /*
+     * constructor - loads the files and starts listening
+     * @param strSocketPath - the path of the unix domain socket, a socket left there by a server that is gone is replaced
+     * @param files - the ini files, loaded in order
+     * @throws invalid_argument - if a file cannot be opened
+     * @throws invalid_format_exception - if a file is invalid
+     * @throws runtime_error - if the socket cannot be created, or the path holds a file or a live server's socket
+     */
+    IniServer(const string& strSocketPath, const vector<string>& files);
+
+    /*
+     * delete copy constructor
+     */
+    IniServer(const IniServer& other) = delete;
+
+    /*
+     * delete copy assignment operator
+     */
+    IniServer& operator=(const IniServer& other) = delete;
+
+    /*
+     * destructor - closes the connections and removes the socket
+     */
+    ~IniServer();
+
+    /*
+     * serves the clients until stop() is called
+     */
+    void run();
+
+    /*
+     * asks run() to return - async-signal-safe, may be called from any thread
+     */
+    void stop();
+
+    /*
+     * asks run() to reload the files - async-signal-safe, may be called from any thread
+     * the current values are kept if the files cannot be loaded
+     */
+    void reload();
+
+private: // types
+    // a client connection, with the bytes not processed nor sent yet
+    struct Connection {
+        int fd;
+        bool bClosed;
+        string strIn;
+        string strOut;
+    };
+
+private: // methods
+    /*
+     * loads the files into a new frozen parser
+     * @return the parser
+     */
+    unique_ptr<IniParser> load() const;
+
+    /*
+     * reads from a connection and queues the answers to the complete requests
+     * @return false if the connection must be closed
+     */
+    bool receive(Connection& connection);
+
+    /*
+     * writes the queued answers of a connection, as much as the socket accepts
+     * @return false if the connection must be closed
+     */
+    bool send(Connection& connection);
+
+    /*
+     * appends the answer to a request
+     * @param pKey - the qualified key
+     * @param nLength - the length of the key
+     * @param strOut - receives the answer
+     */
+    void answer(const char* pKey, size_t nLength, string& strOut) const;
+
+    /*
+     * writes a command to the wake up pipe
+     */
+    void wakeUp(char command);
+
+private: // attributes
+    // holds the path of the socket
+    string m_strSocketPath;
+
+    // holds the files to load
+    vector<string> m_files;
+
+    // holds the values served
+    unique_ptr<IniParser> m_parser;
+
+    // holds the listening socket
+    int m_nListenFd;
+
+    // holds the wake up pipe, read and write ends
+    int m_wakeFds[2];
+
+    // holds the connected clients
+    vector<Connection> m_connections;
+};
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <string>
+#include <atomic>
+#include <cstdint>
+
+#include "IniParser.h"
+
+using namespace std;
+
+// the layout of the posix shared memory, in host byte order, made of offsets only
+// control segment "<name>":                the magic, the generation currently published
+// data segment "<name>.<generation>":      the magic, the generation, the image size, the frozen table image
+// data segments are never modified once published, a new generation goes into a new segment
+#define INI_SHARED_MAGIC            0x314d4853494e49ull     // "INISHM1"
+
+// the control segment - the only shared memory written after publication
+struct IniSharedControl {
+    uint64_t nMagic;
+    atomic<uint32_t> nGeneration;
+};
+
+// the header of a data segment, followed by the image
+struct IniSharedHeader {
+    uint64_t nMagic;
+    uint64_t nGeneration;
+    uint64_t nImageSize;
+};
+
+// the generation is shared between processes, its atomic must not hide a lock
+static_assert(ATOMIC_INT_LOCK_FREE == 2, "The generation counter must be lock free");
+
+/*
+ * IniSharedPublisher
+ * Publishes the values of a parser into posix shared memory, where IniSharedReader looks them up in place.
+ * Every publication goes into a new segment, then the generation counter is bumped, so readers never see
+ * a segment being written. Only one publisher per name.
+ */
+class IniSharedPublisher
+{
+public: // methods
+    /*
+     * constructor - creates the control segment, or continues the generations of an existing one
+     * @param strName - the name of the shared memory, like "/name"
+     * @throws invalid_argument - if the name is invalid
+     * @throws runtime_error - if the shared memory cannot be created
+     */
+    IniSharedPublisher(const string& strName);
+
+    /*
+     * delete copy constructor
+     */
+    IniSharedPublisher(const IniSharedPublisher& other) = delete;
+
+    /*
+     * delete copy assignment operator
+     */
+    IniSharedPublisher& operator=(const IniSharedPublisher& other) = delete;
+
+    /*
+     * destructor - unmaps the control segment, the published values stay available to the readers
+     */
+    ~IniSharedPublisher();
+
+    /*
+     * publishes a new generation of values, the previous generation is removed once readers can see the new one
+     * @param parser - the parser holding the values, frozen or not
+     * @throws runtime_error - if the values cannot be published
+     */
+    void publish(const IniParser& parser);
+
+    /*
+     * @return the generation published last, 0 if none
+     */
+    uint32_t generation() const;
+
+    /*
+     * removes the shared memory - readers already attached keep their values
+     */
+    void unlink();
+
+    /*
+     * @return true if the name can name the shared memory: a slash, then no more slashes
+     */
+    static bool isValidName(const string& strName);
+
+    /*
+     * @return the name of the data segment of a generation
+     */
+    static string segmentName(const string& strName, uint32_t nGeneration);
+
+private: // attributes
+    // holds the name of the shared memory
+    string m_strName;
+
+    // holds the control segment
+    IniSharedControl* m_pControl;
+};
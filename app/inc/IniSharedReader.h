@@ -0,0 +1,79 @@
+#pragma once
+
+#include <string>
+#include <cstdint>
+
+#include "IniSharedPublisher.h"
+
+using namespace std;
+
+/*
+ * IniSharedReader
+ * Attaches read-only to the values published by an IniSharedPublisher and looks keys up in place, without locks.
+ * Every lookup checks the generation counter first and maps the new segment once it was republished.
+ * A reader must not be shared between threads.
+ */
+class IniSharedReader
+{
+public: // methods
+    /*
+     * constructor - attaches to the shared memory and maps the generation currently published
+     * @param strName - the name of the shared memory, like "/name"
+     * @throws invalid_argument - if the name is invalid
+     * @throws runtime_error - if nothing was published under the name
+     */
+    IniSharedReader(const string& strName);
+
+    /*
+     * delete copy constructor
+     */
+    IniSharedReader(const IniSharedReader& other) = delete;
+
+    /*
+     * delete copy assignment operator
+     */
+    IniSharedReader& operator=(const IniSharedReader& other) = delete;
+
+    /*
+     * destructor - unmaps the shared memory
+     */
+    ~IniSharedReader();
+
+    /*
+     * looks up the value associated to a key under a section, in the generation published last
+     * @param strKey - specifies the key to look after
+     * @param strSection - specifies the section to look after, empty for no section
+     * @param strValue - receives the value, untouched if the key is missing
+     * @throws runtime_error - if the new generation cannot be mapped, the previous one is kept
+     * @return true if the key was found
+     */
+    bool find(const string& strKey, const string& strSection, string& strValue);
+
+    /*
+     * @return the generation the last lookup was answered from
+     */
+    uint32_t generation() const;
+
+private: // methods
+    /*
+     * maps the generation published last, if it changed
+     * @throws runtime_error - if it cannot be mapped
+     */
+    void refresh();
+
+private: // attributes
+    // holds the name of the shared memory
+    string m_strName;
+
+    // holds the control segment
+    const IniSharedControl* m_pControl;
+
+    // holds the generation mapped
+    uint32_t m_nGeneration;
+
+    // holds the data segment mapped
+    const char* m_pSegment;
+
+    // holds the size of the data segment mapped
+    size_t m_nSegmentSize;
+};
@@ -0,0 +1,238 @@
+#pragma once
+
+#include <string>
+#include <map>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <cstring>
+#include <cstdint>
+
+using namespace std;
+
+class IniStringPool;
+
+/*
+ * IniString
+ * Immutable, reference counted string handle used to store keys and values.
+ * Copies share the same characters, strings interned by the same IniStringPool share them across parsers.
+ * The handle is a single pointer and the characters live in the same allocation as the counter.
+ */
+class IniString
+{
+public: // methods
+    /*
+     * constructor - builds an empty string, without allocating
+     */
+    IniString();
+
+    /*
+     * constructor - builds a string that is not shared with any pool
+     * @param s - the characters
+     */
+    IniString(const string& s);
+
+    /*
+     * copy constructor - shares the characters
+     */
+    IniString(const IniString& other);
+
+    /*
+     * move constructor
+     */
+    IniString(IniString&& other);
+
+    /*
+     * copy assignment operator - shares the characters
+     */
+    IniString& operator=(const IniString& other);
+
+    /*
+     * move assignment operator
+     */
+    IniString& operator=(IniString&& other);
+
+    /*
+     * destructor - releases the characters if this is their last handle
+     */
+    ~IniString();
+
+    /*
+     * @return the characters, not null terminated
+     */
+    const char* data() const { return m_node->data; }
+
+    /*
+     * @return the number of characters
+     */
+    size_t length() const { return m_node->length; }
+
+    /*
+     * @return a copy of the characters
+     */
+    string str() const { return string(data(), length()); }
+
+    /*
+     * @return true if both handles share the same characters - the cheap equality check
+     */
+    bool same(const IniString& other) const { return m_node == other.m_node; }
+
+    /*
+     * compares the characters with another string, like memcmp
+     * @return a negative value, zero or a positive value if this string is less, equal or greater
+     */
+    int compare(const IniString& other) const { return same(other) ? 0 : compare(other.data(), other.length()); }
+
+    // comparisons fall back to the characters only if the handles don't share them
+    bool operator==(const IniString& other) const { return same(other) || compare(other.data(), other.length()) == 0; }
+    bool operator!=(const IniString& other) const { return !(*this == other); }
+    bool operator<(const IniString& other) const { return !same(other) && compare(other.data(), other.length()) < 0; }
+
+    // mixed comparisons allow looking up plain strings without building a handle
+    friend bool operator<(const IniString& a, const string& b) { return a.compare(b.data(), b.length()) < 0; }
+    friend bool operator<(const string& a, const IniString& b) { return b.compare(a.data(), a.length()) > 0; }
+
+private: // types
+    friend class IniStringPool;
+
+    // the counter, the owner pool if any and the characters, in a single allocation
+    struct Node {
+        atomic<uint32_t> refs;
+        uint32_t length;
+        IniStringPool* pool;
+        char data[1];
+    };
+
+private: // methods
+    /*
+     * constructor - adopts a node, without touching its counter
+     * @param node - the node
+     */
+    explicit IniString(Node* node) : m_node(node) {}
+
+    /*
+     * compares the characters with another sequence, like memcmp
+     */
+    int compare(const char* p, size_t n) const {
+        int nReturn = memcmp(data(), p, length() < n ? length() : n);
+        return nReturn != 0 ? nReturn : (length() < n ? -1 : (length() > n ? 1 : 0));
+    }
+
+    /*
+     * allocates a node holding one reference
+     * @param p - the characters
+     * @param n - the number of characters
+     * @param pool - the owner pool, null if none
+     */
+    static Node* allocate(const char* p, size_t n, IniStringPool* pool);
+
+    /*
+     * frees a node
+     */
+    static void destroy(Node* node);
+
+    /*
+     * @return the node shared by all the empty strings, it is never counted nor freed
+     */
+    static Node* emptyNode();
+
+    /*
+     * adds a reference to the node
+     */
+    void acquire();
+
+    /*
+     * drops a reference to the node, freeing it or handing it back to its pool if it was the last one
+     */
+    void release();
+
+private: // attributes
+    // holds the characters
+    Node* m_node;
+};
+
+// the internal representation of the values, supports lookups by plain strings
+typedef map<IniString, IniString, less<>> IniValues;
+
+/*
+ * IniStringPool
+ * Thread-safe pool of strings shared by many parsers, so identical keys and values are stored once.
+ * Strings are reference counted and leave the pool as soon as their last handle is gone.
+ * A pool must be created via create(); it stays alive while it holds strings.
+ */
+class IniStringPool : public enable_shared_from_this<IniStringPool>
+{
+public: // methods
+    /*
+     * builds an empty pool
+     * @return the new pool
+     */
+    static shared_ptr<IniStringPool> create();
+
+    /*
+     * delete copy constructor
+     */
+    IniStringPool(const IniStringPool& other) = delete;
+
+    /*
+     * delete copy assignment operator
+     */
+    IniStringPool& operator=(const IniStringPool& other) = delete;
+
+    /*
+     * finds or adds a string to the pool
+     * @param s - the characters
+     * @return a handle sharing the pooled characters
+     */
+    IniString intern(const string& s);
+
+    /*
+     * @return the number of distinct strings held by the pool
+     */
+    size_t size() const;
+
+private: // methods
+    friend class IniString;
+
+    /*
+     * constructor - use create()
+     */
+    IniStringPool() : m_nNodes(0) {}
+
+    /*
+     * removes a string from the pool and frees it, once its last handle is gone
+     * @param node - the string
+     */
+    void release(IniString::Node* node);
+
+private: // types
+    // points to the characters of a pooled string, or to the characters looked after
+    struct Key {
+        const char* data;
+        size_t length;
+    };
+
+    // hashes and compares the keys by their characters
+    struct Hash {
+        size_t operator()(const Key& key) const;
+    };
+    struct Equal {
+        bool operator()(const Key& a, const Key& b) const {
+            return a.length == b.length && memcmp(a.data, b.data, a.length) == 0;
+        }
+    };
+
+private: // attributes
+    // holds the pooled strings, the handles own them
+    unordered_map<Key, IniString::Node*, Hash, Equal> m_strings;
+
+    // holds the number of strings allocated by the pool, including those being released
+    size_t m_nNodes;
+
+    // keeps the pool alive while it holds strings
+    shared_ptr<IniStringPool> m_self;
+
+    // guards the pooled strings
+    mutable mutex m_mutex;
+};
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <sys/uio.h>
+#include <sys/types.h>
+
+using namespace std;
+
+/*
+ * IniWriter
+ * Buffered, vectored writer replacing a file atomically.
+ * Small pieces are copied into a buffer, big ones are only referenced and written straight from the caller's memory,
+ * everything goes out with writev. The output goes to a uniquely named temporary file next to the target,
+ * renamed over the target by commit().
+ */
+class IniWriter
+{
+public: // methods
+    /*
+     * constructor - creates the temporary file next to the target
+     * @param strFileName - the file to write
+     * @param nMode - the permissions of the file written
+     * @throws invalid_argument - if the temporary file cannot be created
+     */
+    IniWriter(const string& strFileName, mode_t nMode);
+
+    /*
+     * delete copy constructor
+     */
+    IniWriter(const IniWriter& other) = delete;
+
+    /*
+     * delete copy assignment operator
+     */
+    IniWriter& operator=(const IniWriter& other) = delete;
+
+    /*
+     * destructor - removes the temporary file if commit() was not called
+     */
+    ~IniWriter();
+
+    /*
+     * appends a copy of some bytes to the output
+     * @param p - the bytes
+     * @param n - the number of bytes
+     * @throws runtime_error - if the output cannot be written
+     */
+    void copy(const char* p, size_t n);
+
+    /*
+     * appends a copy of a string to the output
+     * @param s - the string
+     * @throws runtime_error - if the output cannot be written
+     */
+    void copy(const string& s) { copy(s.data(), s.length()); }
+
+    /*
+     * appends some bytes to the output without copying them, unless they are few
+     * @param p - the bytes, they must stay valid until commit()
+     * @param n - the number of bytes
+     * @throws runtime_error - if the output cannot be written
+     */
+    void reference(const char* p, size_t n);
+
+    /*
+     * writes everything appended so far and replaces the target file
+     * @throws runtime_error - if the output cannot be written
+     */
+    void commit();
+
+private: // methods
+    /*
+     * writes the pending pieces
+     * @throws runtime_error - if the output cannot be written
+     */
+    void flush();
+
+private: // attributes
+    // holds the target file
+    string m_strFileName;
+
+    // holds the temporary file
+    string m_strTempFileName;
+
+    // holds the temporary file descriptor, -1 once committed
+    int m_nFd;
+
+    // holds the small pieces copied so far
+    vector<char> m_buffer;
+
+    // holds the pieces not written yet
+    vector<iovec> m_pieces;
+};
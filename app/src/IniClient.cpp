@@ -0,0 +1,136 @@
+#include <stdexcept>
+#include <algorithm>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "IniClient.h"
+#include "IniServer.h"
+
+using namespace std;
+
+// number of requests encoded at once
+#define CLIENT_BATCH_SIZE       1024
+// bytes read at once from the server
+#define CLIENT_READ_SIZE        (64 * 1024)
+
+IniClient::IniClient(const string& strSocketPath)
+    : m_nInOffset(0)
+{
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    if (strSocketPath.empty() || strSocketPath.length() >= sizeof(address.sun_path))
+        throw invalid_argument("Invalid socket path " + strSocketPath);
+    strncpy(address.sun_path, strSocketPath.c_str(), sizeof(address.sun_path) - 1);
+
+    m_nFd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (m_nFd < 0 || connect(m_nFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        string strError = strerror(errno);
+        if (m_nFd >= 0)
+            close(m_nFd);
+        throw runtime_error("Unable to connect to " + strSocketPath + ": " + strError);
+    }
+
+    // requests and answers flow at the same time, neither side may block the other
+    fcntl(m_nFd, F_SETFL, fcntl(m_nFd, F_GETFL, 0) | O_NONBLOCK);
+}
+
+IniClient::~IniClient() {
+    close(m_nFd);
+}
+
+void IniClient::query(const vector<string>& keys, vector<Answer>& answers) {
+
+    for (const string& strKey : keys)
+        if (strKey.length() > INI_PROTOCOL_MAX_REQUEST)
+            throw invalid_argument("The key is too long: " + strKey);
+
+    answers.resize(keys.size());
+
+    // the server stops reading while too many answers wait, so answers are read as soon as they come
+    // even if requests are left to send
+    string strOut;
+    size_t nOutOffset = 0;
+    size_t nEncoded = 0;
+    size_t nAnswered = 0;
+
+    while (nAnswered < keys.size()) {
+        // encode the requests a batch at a time
+        if (nOutOffset == strOut.length() && nEncoded < keys.size()) {
+            strOut.clear();
+            nOutOffset = 0;
+            for (size_t nEnd = min(nEncoded + CLIENT_BATCH_SIZE, keys.size()); nEncoded < nEnd; nEncoded++) {
+                uint32_t nLength = static_cast<uint32_t>(keys[nEncoded].length());
+                strOut.append(reinterpret_cast<const char*>(&nLength), sizeof(nLength));
+                strOut.append(keys[nEncoded]);
+            }
+        }
+
+        pollfd fd = { m_nFd, static_cast<short>(POLLIN | (nOutOffset < strOut.length() ? POLLOUT : 0)), 0 };
+        if (poll(&fd, 1, -1) < 0) {
+            if (errno == EINTR)
+                continue;
+            throw runtime_error(string("Unable to wait for the server: ") + strerror(errno));
+        }
+
+        if (fd.revents & (POLLIN | POLLHUP | POLLERR)) {
+            receive();
+            while (nAnswered < keys.size() && takeAnswer(answers[nAnswered]))
+                nAnswered++;
+        }
+
+        if ((fd.revents & POLLOUT) && nOutOffset < strOut.length()) {
+            ssize_t nWritten = send(m_nFd, strOut.data() + nOutOffset, strOut.length() - nOutOffset, MSG_NOSIGNAL);
+            if (nWritten < 0 && errno != EINTR && errno != EAGAIN && errno != EWOULDBLOCK)
+                throw runtime_error(string("Unable to send the queries: ") + strerror(errno));
+            if (nWritten > 0)
+                nOutOffset += nWritten;
+        }
+    }
+}
+
+void IniClient::receive() {
+
+    // drop the bytes consumed before appending more
+    if (m_nInOffset > 0) {
+        m_strIn.erase(0, m_nInOffset);
+        m_nInOffset = 0;
+    }
+
+    char buffer[CLIENT_READ_SIZE];
+    for (;;) {
+        ssize_t nRead = recv(m_nFd, buffer, sizeof(buffer), 0);
+        if (nRead < 0 && errno == EINTR)
+            continue;
+        if (nRead < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            return;
+        if (nRead <= 0)
+            throw runtime_error("The server closed the connection");
+        m_strIn.append(buffer, nRead);
+        if (static_cast<size_t>(nRead) < sizeof(buffer))
+            return;
+    }
+}
+
+bool IniClient::takeAnswer(Answer& answer) {
+
+    uint8_t nStatus;
+    uint32_t nLength;
+    if (m_strIn.length() - m_nInOffset < sizeof(nStatus) + sizeof(nLength))
+        return false;
+
+    memcpy(&nStatus, m_strIn.data() + m_nInOffset, sizeof(nStatus));
+    memcpy(&nLength, m_strIn.data() + m_nInOffset + sizeof(nStatus), sizeof(nLength));
+    if (m_strIn.length() - m_nInOffset - sizeof(nStatus) - sizeof(nLength) < nLength)
+        return false;
+
+    m_nInOffset += sizeof(nStatus) + sizeof(nLength);
+    answer.bFound = nStatus == INI_PROTOCOL_FOUND;
+    answer.strValue.assign(m_strIn, m_nInOffset, nLength);
+    m_nInOffset += nLength;
+    return true;
+}
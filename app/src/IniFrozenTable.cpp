@@ -0,0 +1,295 @@
+#include <algorithm>
+#include <stdexcept>
+#include <cstring>
+
+#include "IniFrozenTable.h"
+
+using namespace std;
+
+#define OP_SECTION_KEY_CAT      '.'
+
+// average number of keys per bucket - smaller means easier placement, but a bigger table
+#define MPH_KEYS_PER_BUCKET     2
+// give up on a seed after this many displacements for a single bucket
+#define MPH_MAX_DISPLACEMENTS   (1u << 22)
+// give up on building after this many seeds
+#define MPH_MAX_SEEDS           64
+// marks a bucket holding a single key, placed directly
+#define MPH_DIRECT              0x80000000u
+
+#define FNV_OFFSET              0xcbf29ce484222325ull
+#define FNV_PRIME               0x100000001b3ull
+
+// splitmix64 finalizer - spreads the bits of the fnv hash over the whole word
+static uint64_t mix(uint64_t h) {
+    h ^= h >> 30;
+    h *= 0xbf58476d1ce4e5b9ull;
+    h ^= h >> 27;
+    h *= 0x94d049bb133111ebull;
+    h ^= h >> 31;
+    return h;
+}
+
+static uint64_t fnv(uint64_t h, const char* p, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        h ^= static_cast<unsigned char>(p[i]);
+        h *= FNV_PRIME;
+    }
+    return h;
+}
+
+IniFrozenTable::IniFrozenTable() {
+    clear();
+}
+
+void IniFrozenTable::build(const IniValues& values) {
+
+    clear();
+
+    if (values.empty())
+        return;
+
+    if (values.size() >= MPH_DIRECT)
+        throw runtime_error("Unable to freeze values! Too many values");
+
+    vector<const IniString*> keys;
+    keys.reserve(values.size());
+
+    size_t nPoolSize = 0;
+    for (auto it = values.begin(); it != values.end(); ++it) {
+        keys.push_back(&it->first);
+        nPoolSize += it->first.length() + it->second.length();
+    }
+
+    vector<size_t> slots;
+    uint64_t nSeed = 0;
+    while (!place(keys, nSeed, slots)) {
+        if (++nSeed == MPH_MAX_SEEDS) {
+            clear();
+            throw runtime_error("Unable to freeze values! No perfect hash found");
+        }
+    }
+    m_nSeed = nSeed;
+
+    // pack keys and values into the pool, in key order, so neighbouring keys share pages
+    m_strPool.reserve(nPoolSize);
+
+    size_t i = 0;
+    for (auto it = values.begin(); it != values.end(); ++it, ++i) {
+        Entry& entry = m_entries[slots[i]];
+        entry.nOffset = m_strPool.length();
+        entry.nKeyLength = static_cast<uint32_t>(it->first.length());
+        entry.nValueLength = static_cast<uint32_t>(it->second.length());
+        m_strPool.append(it->first.data(), it->first.length());
+        m_strPool.append(it->second.data(), it->second.length());
+    }
+}
+
+bool IniFrozenTable::place(const vector<const IniString*>& keys, uint64_t nSeed, vector<size_t>& slots) {
+
+    const size_t nKeys = keys.size();
+    const size_t nBuckets = nKeys / MPH_KEYS_PER_BUCKET + 1;
+
+    m_displacements.assign(nBuckets, 0);
+    slots.assign(nKeys, 0);
+
+    // split keys into buckets
+    vector<uint64_t> hashes(nKeys);
+    vector<vector<size_t>> buckets(nBuckets);
+    for (size_t i = 0; i < nKeys; i++) {
+        hashes[i] = hash(keys[i]->data(), keys[i]->length(), "", nSeed);
+        buckets[hashes[i] % nBuckets].push_back(i);
+    }
+
+    // place the biggest buckets first, while the table is still empty
+    vector<size_t> order(nBuckets);
+    for (size_t b = 0; b < nBuckets; b++)
+        order[b] = b;
+    stable_sort(order.begin(), order.end(), [&buckets](size_t a, size_t b) {
+        return buckets[a].size() > buckets[b].size();
+    });
+
+    m_entries.resize(nKeys);
+
+    vector<bool> taken(nKeys, false);
+    vector<size_t> candidates;
+    size_t nFree = 0;
+
+    for (size_t b : order) {
+        const vector<size_t>& bucket = buckets[b];
+
+        if (bucket.size() > 1) {
+            uint32_t d = 0;
+            for (; d < MPH_MAX_DISPLACEMENTS; d++) {
+                candidates.clear();
+                for (size_t k : bucket) {
+                    size_t s = slot(hashes[k], d, nKeys);
+                    if (taken[s] || std::find(candidates.begin(), candidates.end(), s) != candidates.end())
+                        break;
+                    candidates.push_back(s);
+                }
+                if (candidates.size() == bucket.size())
+                    break;
+            }
+            if (d == MPH_MAX_DISPLACEMENTS)
+                return false;
+
+            m_displacements[b] = d;
+            for (size_t j = 0; j < bucket.size(); j++) {
+                taken[candidates[j]] = true;
+                slots[bucket[j]] = candidates[j];
+            }
+        } else if (bucket.size() == 1) {
+            // singletons don't need to search, they take the next free slot
+            while (taken[nFree])
+                nFree++;
+            taken[nFree] = true;
+            slots[bucket[0]] = nFree;
+            m_displacements[b] = MPH_DIRECT | static_cast<uint32_t>(nFree);
+        }
+    }
+
+    return true;
+}
+
+void IniFrozenTable::extract(IniValues& values) const {
+
+    for (const Entry& entry : m_entries)
+        values[IniString(m_strPool.substr(entry.nOffset, entry.nKeyLength))] =
+            IniString(m_strPool.substr(entry.nOffset + entry.nKeyLength, entry.nValueLength));
+}
+
+bool IniFrozenTable::find(const string& strKey, const string& strSection, string& strValue) const {
+
+    View view = { m_nSeed, m_displacements.data(), m_displacements.size(), m_entries.data(), m_entries.size(), m_strPool.data() };
+    return find(view, strKey, strSection, strValue);
+}
+
+size_t IniFrozenTable::imageSize() const {
+    return entriesOffset(m_displacements.size()) + m_entries.size() * sizeof(Entry) + m_strPool.length();
+}
+
+void IniFrozenTable::writeImage(char* pImage) const {
+
+    ImageHeader header = { m_nSeed, m_displacements.size(), m_entries.size(), m_strPool.length() };
+    memcpy(pImage, &header, sizeof(header));
+
+    size_t nEntriesOffset = entriesOffset(header.nBuckets);
+    memset(pImage + sizeof(header), 0, nEntriesOffset - sizeof(header));
+    memcpy(pImage + sizeof(header), m_displacements.data(), m_displacements.size() * sizeof(uint32_t));
+    memcpy(pImage + nEntriesOffset, m_entries.data(), m_entries.size() * sizeof(Entry));
+    memcpy(pImage + nEntriesOffset + m_entries.size() * sizeof(Entry), m_strPool.data(), m_strPool.length());
+}
+
+bool IniFrozenTable::isImage(const char* pImage, size_t nSize) {
+
+    if (nSize < sizeof(ImageHeader))
+        return false;
+
+    const ImageHeader& header = *reinterpret_cast<const ImageHeader*>(pImage);
+    if ((header.nEntries == 0) != (header.nBuckets == 0) || header.nEntries >= MPH_DIRECT || header.nBuckets > header.nEntries + 1)
+        return false;
+
+    size_t nPoolOffset = entriesOffset(header.nBuckets) + header.nEntries * sizeof(Entry);
+    if (nPoolOffset > nSize || header.nPoolSize > nSize - nPoolOffset)
+        return false;
+
+    // every slot must point into the pool
+    const Entry* pEntries = reinterpret_cast<const Entry*>(pImage + entriesOffset(header.nBuckets));
+    for (size_t i = 0; i < header.nEntries; i++) {
+        const Entry& entry = pEntries[i];
+        if (entry.nOffset > header.nPoolSize || uint64_t(entry.nKeyLength) + entry.nValueLength > header.nPoolSize - entry.nOffset)
+            return false;
+    }
+
+    const uint32_t* pDisplacements = reinterpret_cast<const uint32_t*>(pImage + sizeof(ImageHeader));
+    for (size_t b = 0; b < header.nBuckets; b++)
+        if ((pDisplacements[b] & MPH_DIRECT) && (pDisplacements[b] & ~MPH_DIRECT) >= header.nEntries)
+            return false;
+
+    return true;
+}
+
+bool IniFrozenTable::find(const char* pImage, const string& strKey, const string& strSection, string& strValue) {
+
+    const ImageHeader& header = *reinterpret_cast<const ImageHeader*>(pImage);
+    size_t nEntriesOffset = entriesOffset(header.nBuckets);
+
+    View view = {
+        header.nSeed,
+        reinterpret_cast<const uint32_t*>(pImage + sizeof(ImageHeader)),
+        header.nBuckets,
+        reinterpret_cast<const Entry*>(pImage + nEntriesOffset),
+        header.nEntries,
+        pImage + nEntriesOffset + header.nEntries * sizeof(Entry)
+    };
+    return find(view, strKey, strSection, strValue);
+}
+
+bool IniFrozenTable::find(const View& view, const string& strKey, const string& strSection, string& strValue) {
+
+    if (view.nEntries == 0)
+        return false;
+
+    uint64_t h = hash(strKey.data(), strKey.length(), strSection, view.nSeed);
+    const Entry& entry = view.pEntries[slot(h, view.pDisplacements[h % view.nBuckets], view.nEntries)];
+
+    // compare against "section.key" piece by piece
+    const char* p = view.pPool + entry.nOffset;
+    size_t nLength = strSection.empty() ? strKey.length() : strSection.length() + 1 + strKey.length();
+    if (entry.nKeyLength != nLength)
+        return false;
+
+    if (!strSection.empty()) {
+        if (memcmp(p, strSection.data(), strSection.length()) != 0)
+            return false;
+        p += strSection.length();
+        if (*p++ != OP_SECTION_KEY_CAT)
+            return false;
+    }
+
+    if (memcmp(p, strKey.data(), strKey.length()) != 0)
+        return false;
+
+    strValue.assign(view.pPool + entry.nOffset + entry.nKeyLength, entry.nValueLength);
+    return true;
+}
+
+size_t IniFrozenTable::entriesOffset(size_t nBuckets) {
+
+    // the entries hold 64 bits offsets, keep them aligned
+    size_t nOffset = sizeof(ImageHeader) + nBuckets * sizeof(uint32_t);
+    return (nOffset + 7) & ~size_t(7);
+}
+
+size_t IniFrozenTable::size() const {
+    return m_entries.size();
+}
+
+void IniFrozenTable::clear() {
+    m_nSeed = 0;
+    vector<uint32_t>().swap(m_displacements);
+    vector<Entry>().swap(m_entries);
+    string().swap(m_strPool);
+}
+
+uint64_t IniFrozenTable::hash(const char* pKey, size_t nKeyLength, const string& strSection, uint64_t nSeed) {
+
+    uint64_t h = FNV_OFFSET ^ mix(nSeed);
+
+    if (!strSection.empty()) {
+        const char cat = OP_SECTION_KEY_CAT;
+        h = fnv(h, strSection.data(), strSection.length());
+        h = fnv(h, &cat, 1);
+    }
+
+    return mix(fnv(h, pKey, nKeyLength));
+}
+
+size_t IniFrozenTable::slot(uint64_t nHash, uint32_t nDisplacement, size_t nEntries) {
+
+    if (nDisplacement & MPH_DIRECT)
+        return nDisplacement & ~MPH_DIRECT;
+
+    return mix(nHash + nDisplacement * 0x9e3779b97f4a7c15ull) % nEntries;
+}
@@ -0,0 +1,161 @@
+#include <zlib.h>
+
+#include "IniGzipStreamBuf.h"
+
+using namespace std;
+
+// size of a compressed or inflated chunk
+#define GZ_CHUNK_SIZE           (64 * 1024)
+// number of inflated chunks waiting for the parser before decompression blocks
+#define GZ_MAX_CHUNKS           4
+// zlib window bits, +16 accepts only gzip wrapped streams
+#define GZ_WINDOW_BITS          (15 + 16)
+
+#define GZ_MAGIC1               0x1f
+#define GZ_MAGIC2               0x8b
+
+IniGzipStreamBuf::IniGzipStreamBuf(istream& source)
+    : m_source(source),
+      m_bDone(false),
+      m_bStop(false)
+{
+    setg(nullptr, nullptr, nullptr);
+    m_thread = thread(&IniGzipStreamBuf::inflateAll, this);
+}
+
+IniGzipStreamBuf::~IniGzipStreamBuf() {
+
+    {
+        lock_guard<mutex> lock(m_mutex);
+        m_bStop = true;
+    }
+    m_condition.notify_all();
+
+    m_thread.join();
+}
+
+bool IniGzipStreamBuf::isGzip(istream& source) {
+
+    int c1 = source.get();
+    int c2 = source.peek();
+    if (c1 != char_traits<char>::eof())
+        source.unget();
+
+    // an empty input leaves eof set after peeking, so clear it
+    source.clear();
+
+    return c1 == GZ_MAGIC1 && c2 == GZ_MAGIC2;
+}
+
+string IniGzipStreamBuf::error() const {
+
+    lock_guard<mutex> lock(m_mutex);
+    return m_strError;
+}
+
+IniGzipStreamBuf::int_type IniGzipStreamBuf::underflow() {
+
+    if (gptr() < egptr())
+        return traits_type::to_int_type(*gptr());
+
+    unique_lock<mutex> lock(m_mutex);
+
+    // give the consumed chunk back
+    if (!m_current.empty()) {
+        m_free.push_back(move(m_current));
+        m_current.clear();
+        m_condition.notify_all();
+    }
+
+    m_condition.wait(lock, [this] { return !m_filled.empty() || m_bDone; });
+
+    if (m_filled.empty())
+        return traits_type::eof();
+
+    m_current = move(m_filled.front());
+    m_filled.pop_front();
+    m_condition.notify_all();
+
+    setg(m_current.data(), m_current.data(), m_current.data() + m_current.size());
+    return traits_type::to_int_type(*gptr());
+}
+
+bool IniGzipStreamBuf::push(vector<char>& chunk) {
+
+    unique_lock<mutex> lock(m_mutex);
+
+    m_condition.wait(lock, [this] { return m_filled.size() < GZ_MAX_CHUNKS || m_bStop; });
+    if (m_bStop)
+        return false;
+
+    m_filled.push_back(move(chunk));
+
+    // reuse a consumed chunk if there is one, so the steady state does not allocate
+    if (!m_free.empty()) {
+        chunk = move(m_free.front());
+        m_free.pop_front();
+    } else {
+        chunk = vector<char>();
+    }
+
+    m_condition.notify_all();
+    return true;
+}
+
+void IniGzipStreamBuf::inflateAll() {
+
+    string strError;
+    vector<char> in(GZ_CHUNK_SIZE);
+    vector<char> out;
+
+    z_stream stream = {};
+    if (inflateInit2(&stream, GZ_WINDOW_BITS) != Z_OK) {
+        strError = "Unable to initialize the gzip decompression";
+    } else {
+        bool bStop = false;
+        bool bMember = false;   // true while inside a gzip member
+
+        while (!bStop && strError.empty()) {
+            // refill the input
+            if (stream.avail_in == 0) {
+                m_source.read(in.data(), in.size());
+                stream.next_in = reinterpret_cast<Bytef*>(in.data());
+                stream.avail_in = static_cast<uInt>(m_source.gcount());
+
+                if (stream.avail_in == 0) {
+                    if (m_source.bad())
+                        strError = "Unable to read the gzip input";
+                    else if (bMember)
+                        strError = "Truncated gzip input";
+                    break;
+                }
+            }
+
+            out.resize(GZ_CHUNK_SIZE);
+            stream.next_out = reinterpret_cast<Bytef*>(out.data());
+            stream.avail_out = static_cast<uInt>(out.size());
+
+            bMember = true;
+            int nReturn = inflate(&stream, Z_NO_FLUSH);
+            if (nReturn == Z_STREAM_END) {
+                // concatenated members form a single gzip stream
+                inflateReset(&stream);
+                bMember = false;
+            } else if (nReturn != Z_OK && nReturn != Z_BUF_ERROR) {
+                strError = string("Invalid gzip input: ") + (stream.msg ? stream.msg : "unknown error");
+                break;
+            }
+
+            out.resize(out.size() - stream.avail_out);
+            if (!out.empty())
+                bStop = !push(out);
+        }
+
+        inflateEnd(&stream);
+    }
+
+    lock_guard<mutex> lock(m_mutex);
+    m_strError = strError;
+    m_bDone = true;
+    m_condition.notify_all();
+}
@@ -0,0 +1,66 @@
+#include "IniLoadFilter.h"
+
+using namespace std;
+
+#define OP_SECTION_KEY_CAT      '.'
+
+// checks if a string starts with a prefix
+static bool startsWith(const string& s, const string& strPrefix) {
+    return s.compare(0, strPrefix.length(), strPrefix) == 0;
+}
+
+IniLoadFilter::IniLoadFilter() {
+}
+
+IniLoadFilter& IniLoadFilter::addSection(const string& strSection) {
+    m_sections.insert(strSection);
+    return *this;
+}
+
+IniLoadFilter& IniLoadFilter::addKeyPrefix(const string& strPrefix) {
+    m_keyPrefixes.push_back(strPrefix);
+    return *this;
+}
+
+IniLoadFilter& IniLoadFilter::setSectionPredicate(const function<bool(const string&)>& predicate) {
+    m_sectionPredicate = predicate;
+    return *this;
+}
+
+bool IniLoadFilter::empty() const {
+    return m_sections.empty() && m_keyPrefixes.empty() && !m_sectionPredicate;
+}
+
+bool IniLoadFilter::acceptsSection(const string& strSection) const {
+
+    if (acceptsWholeSection(strSection))
+        return true;
+
+    // the keys outside any section are not prefixed, any of them may match
+    if (strSection.empty())
+        return !m_keyPrefixes.empty();
+
+    // the keys of the section start with "section.", a prefix matches some of them
+    // if it is a prefix of "section." or if it starts with "section."
+    string strKeyStart = strSection + OP_SECTION_KEY_CAT;
+    for (const string& strPrefix : m_keyPrefixes) {
+        if (startsWith(strKeyStart, strPrefix) || startsWith(strPrefix, strKeyStart))
+            return true;
+    }
+
+    return false;
+}
+
+bool IniLoadFilter::acceptsWholeSection(const string& strSection) const {
+    return empty() || m_sections.count(strSection) != 0 || (m_sectionPredicate && m_sectionPredicate(strSection));
+}
+
+bool IniLoadFilter::acceptsKey(const string& strQualifiedKey) const {
+
+    for (const string& strPrefix : m_keyPrefixes) {
+        if (startsWith(strQualifiedKey, strPrefix))
+            return true;
+    }
+
+    return false;
+}
@@ -1,9 +1,21 @@
 #include <iostream>
 #include <fstream>
 #include <exception>
+#include <memory>
+#include <algorithm>
+#include <limits>
+#include <cstring>
+#include <cerrno>
+#include <functional>
 #include <assert.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 #include "IniParser.h"
+#include "IniGzipStreamBuf.h"
+#include "IniWriter.h"
 
 using namespace std;
 
@@ -16,9 +28,92 @@ using namespace std;
 
 #define REG_SPACES              "([\\s|\\t]*)" 
 
+// character of a staged key at a given depth, -1 past its end
+static inline int stagedChar(const vector<pair<string, string>>& staged, size_t nIndex, size_t nDepth) {
+    const string& strKey = staged[nIndex].first;
+    return nDepth < strKey.length() ? static_cast<unsigned char>(strKey[nDepth]) : -1;
+}
+
+// sorts the indices of staged keys, equal keys by index - three way radix quicksort
+// qualified keys share long section prefixes, which this sort compares only once per partition
+static void sortStaged(const vector<pair<string, string>>& staged, size_t* order, size_t n, size_t nDepth) {
+
+    while (n > 1) {
+        // small partitions are faster with plain comparisons
+        if (n < 16) {
+            sort(order, order + n, [&staged, nDepth](size_t a, size_t b) {
+                int nCompare = staged[a].first.compare(nDepth, string::npos, staged[b].first, nDepth, string::npos);
+                return nCompare < 0 || (nCompare == 0 && a < b);
+            });
+            return;
+        }
+
+        int nPivot = stagedChar(staged, order[n / 2], nDepth);
+        size_t lt = 0, i = 0, gt = n;
+        while (i < gt) {
+            int c = stagedChar(staged, order[i], nDepth);
+            if (c < nPivot)
+                swap(order[lt++], order[i++]);
+            else if (c > nPivot)
+                swap(order[i], order[--gt]);
+            else
+                i++;
+        }
+
+        sortStaged(staged, order, lt, nDepth);
+        sortStaged(staged, order + gt, n - gt, nDepth);
+
+        // keys that ended are equal, keep them in file order
+        if (nPivot < 0) {
+            sort(order + lt, order + gt);
+            return;
+        }
+
+        order += lt;
+        n = gt - lt;
+        nDepth++;
+    }
+}
+
+// checks a key against the key regex: _ repeat letter  digit or letter or _ repeat
+static bool isKeyName(const char* p, size_t n) {
+
+    size_t i = 0;
+    while (i < n && p[i] == '_')
+        i++;
+    if (i == n || !isalpha(static_cast<unsigned char>(p[i])))
+        return false;
+
+    for (; i < n; i++)
+        if (!isalnum(static_cast<unsigned char>(p[i])) && p[i] != '_')
+            return false;
+    return true;
+}
+
+// parses a section header between p and e, already past the leading spaces
+static bool parseSectionHeader(const char* p, const char* e, string& strSection) {
+
+    if (p == e || *p != OP_SECTION_START[0])
+        return false;
+
+    const char* pEnd = static_cast<const char*>(memchr(p + 1, OP_SECTION_END[0], e - p - 1));
+    if (!pEnd || pEnd == p + 1)
+        return false;
+
+    for (const char* q = pEnd + 1; q < e; q++)
+        if (!isspace(static_cast<unsigned char>(*q)))
+            return false;
+
+    strSection.assign(p + 1, pEnd);
+    return true;
+}
+
 IniParser::IniParser(bool bSkipInvalidLines) {
 
     m_bSkipInvalidLines = bSkipInvalidLines;
+    m_bFrozen = false;
+    m_bSkipSection = false;
+    m_bKeepSection = true;
 
     stringstream stream;
 
@@ -66,7 +161,14 @@ IniParser::IniParser(const IniParser& other) {
 	m_regexComment 				= other.m_regexComment;
 	m_regexSection 				= other.m_regexSection;
 	m_regexKeyValueAssigment 	= other.m_regexKeyValueAssigment;
-	m_values.insert(other.m_values.begin(), other.m_values.end());
+	m_values 					= other.m_values;
+	m_frozenValues 				= other.m_frozenValues;
+	m_bFrozen 					= other.m_bFrozen;
+	m_stringPool 				= other.m_stringPool;
+	m_loadFilter 				= other.m_loadFilter;
+	m_bSkipSection 				= other.m_bSkipSection;
+	m_bKeepSection 				= other.m_bKeepSection;
+	m_edits 					= other.m_edits;
 }
 
 
@@ -76,7 +178,14 @@ IniParser& IniParser::operator=(const IniParser& other) {
 	m_regexComment 				= other.m_regexComment;
 	m_regexSection 				= other.m_regexSection;
 	m_regexKeyValueAssigment 	= other.m_regexKeyValueAssigment;
-	m_values.insert(other.m_values.begin(), other.m_values.end());
+	m_values 					= other.m_values;
+	m_frozenValues 				= other.m_frozenValues;
+	m_bFrozen 					= other.m_bFrozen;
+	m_stringPool 				= other.m_stringPool;
+	m_loadFilter 				= other.m_loadFilter;
+	m_bSkipSection 				= other.m_bSkipSection;
+	m_bKeepSection 				= other.m_bKeepSection;
+	m_edits 					= other.m_edits;
 
 	return *this;
 }
@@ -87,22 +196,59 @@ int IniParser::updateFromFile(const string &strFileName) {
     if (strFileName.empty())
         throw invalid_argument("The input file name is empty!");
 
+    // frozen tables are read-only
+    if (m_bFrozen)
+        throw logic_error("The parser is frozen, unable to update from " + strFileName);
+
     // open file to read from
-    ifstream ifs(strFileName, std::ifstream::in);
+    ifstream ifs(strFileName, std::ifstream::in | std::ifstream::binary);
 
     // check if file was open
     if (ifs.fail())
         throw invalid_argument("Unable to open the input file " + strFileName);
 
+    // gzip compressed files are inflated on a second thread while this one parses
+    // the stream buffer is declared after the file, so its thread is joined before the file closes
+    unique_ptr<IniGzipStreamBuf> gzipBuffer;
+    if (IniGzipStreamBuf::isGzip(ifs)) {
+        logInfo("inflating " + strFileName);
+        gzipBuffer.reset(new IniGzipStreamBuf(ifs));
+    }
+    istream is(gzipBuffer ? static_cast<streambuf*>(gzipBuffer.get()) : ifs.rdbuf());
+
     // start with an empty section
     m_strCurrentSection = "";
+    filterSection();
+
+    // the values are staged and merged only once the whole file was parsed
+    vector<pair<string, string>> staged;
 
     logInfo("reading " + strFileName);
-    while (!ifs.eof()) {
+    while (!is.eof()) {
         string strLine;
 
+        // lines of skipped sections are not read nor classified, only the next section header is looked after
+        if (m_bSkipSection) {
+            if (!peekSection(is)) {
+                is.ignore(numeric_limits<streamsize>::max(), '\n');
+                continue;
+            }
+
+            getline(is, strLine);
+            try {
+                if (regex_match(strLine, m_regexSection)) {
+                    logInfo("matched section: " + trim(strLine));
+                    handleSection(trim(strLine));
+                }
+            } catch (const regex_error &ex) {
+                logError("regex exception");
+                return -1;
+            }
+            continue;
+        }
+
         // read line
-        getline(ifs, strLine);
+        getline(is, strLine);
 
         //skip empty lines
         if (strLine.empty()) {
@@ -129,7 +275,7 @@ int IniParser::updateFromFile(const string &strFileName) {
             // match key value assigment
             if (regex_match(strLine, matcher, m_regexKeyValueAssigment)) {
                 logInfo("matched key value assigment: " + trim(matcher[0]));
-                handleKeyValueAssigment(trim(matcher[0]));
+                handleKeyValueAssigment(trim(matcher[0]), staged);
                 continue;
             }
         } catch (const regex_error &ex) {
@@ -145,9 +291,16 @@ int IniParser::updateFromFile(const string &strFileName) {
         }
     }
 
+    if (gzipBuffer && !gzipBuffer->error().empty()) {
+        logError(gzipBuffer->error());
+        throw runtime_error(gzipBuffer->error() + " in " + strFileName);
+    }
+
     ifs.close();
     logInfo("done reading " + strFileName);
 
+    mergeStaged(staged);
+
     // display the internal representation of the parser
     logValues();
 
@@ -155,7 +308,7 @@ int IniParser::updateFromFile(const string &strFileName) {
 }
 
 size_t IniParser::size() const {
-    return m_values.size();
+    return m_bFrozen ? m_frozenValues.size() : m_values.size();
 }
 
 
@@ -165,24 +318,316 @@ size_t IniParser::max_size() const {
 
 void IniParser::clear() {
     m_values.clear();
+    m_frozenValues.clear();
+    m_bFrozen = false;
+    m_edits.clear();
     m_strCurrentSection = "";
 }
 
-const string &IniParser::getValue(const string &strKey, const string &strSection) const {
+void IniParser::freeze() {
+
+    if (m_bFrozen)
+        return;
+
+    m_frozenValues.build(m_values);
+    IniValues().swap(m_values);
+    m_bFrozen = true;
+}
+
+void IniParser::unfreeze() {
+
+    if (!m_bFrozen)
+        return;
+
+    m_frozenValues.extract(m_values);
+    m_frozenValues.clear();
+    m_bFrozen = false;
+
+    internValues();
+}
+
+bool IniParser::isFrozen() const {
+    return m_bFrozen;
+}
+
+void IniParser::setStringPool(const shared_ptr<IniStringPool>& stringPool) {
+
+    m_stringPool = stringPool;
+    internValues();
+}
+
+void IniParser::setLoadFilter(const IniLoadFilter& loadFilter) {
+    m_loadFilter = loadFilter;
+}
+
+IniString IniParser::intern(const string& s) const {
+    return m_stringPool ? m_stringPool->intern(s) : IniString(s);
+}
+
+IniString IniParser::intern(const IniString& s) const {
+    return m_stringPool ? m_stringPool->intern(s.str()) : s;
+}
+
+void IniParser::recordEdit(const string& strQualifiedKey) {
+
+    // keys never contain the separator, so the section ends at the last one
+    size_t nSeparator = strQualifiedKey.rfind(OP_SECTION_KEY_CAT);
+    if (nSeparator == string::npos)
+        m_edits[""].insert(strQualifiedKey);
+    else
+        m_edits[strQualifiedKey.substr(0, nSeparator)].insert(strQualifiedKey.substr(nSeparator + 1));
+}
+
+void IniParser::internValues() {
+
+    if (!m_stringPool)
+        return;
+
+    // keys keep their order, so the new map can be built with hints in linear time
+    IniValues values;
+    for (auto it = m_values.begin(); it != m_values.end(); ++it)
+        values.emplace_hint(values.end(), m_stringPool->intern(it->first.str()), m_stringPool->intern(it->second.str()));
+
+    m_values.swap(values);
+}
+
+IniParser::change_set IniParser::diff(const IniParser& from, const IniParser& to) {
+
+    if (from.m_bFrozen || to.m_bFrozen)
+        throw logic_error("Unable to diff frozen parsers!");
+
+    change_set changes;
+
+    // both maps are sorted by key, so a single merge pass finds all the changes
+    // parsers sharing a string pool compare their values by address
+    IniValues::const_iterator itFrom = from.m_values.begin();
+    IniValues::const_iterator itTo = to.m_values.begin();
+
+    while (itFrom != from.m_values.end() || itTo != to.m_values.end()) {
+        int nCompare;
+        if (itFrom == from.m_values.end())
+            nCompare = 1;
+        else if (itTo == to.m_values.end())
+            nCompare = -1;
+        else
+            nCompare = itFrom->first.compare(itTo->first);
+
+        if (nCompare < 0) {
+            changes.push_back(change{ change::removed, itFrom->first, IniString() });
+            ++itFrom;
+        } else if (nCompare > 0) {
+            changes.push_back(change{ change::added, itTo->first, itTo->second });
+            ++itTo;
+        } else {
+            if (itFrom->second != itTo->second)
+                changes.push_back(change{ change::changed, itTo->first, itTo->second });
+            ++itFrom;
+            ++itTo;
+        }
+    }
+
+    return changes;
+}
+
+void IniParser::apply(const change_set& changes) {
+
+    if (m_bFrozen)
+        throw logic_error("The parser is frozen, unable to apply changes");
+
+    try {
+        // while the changes come sorted, the elements before the hint are less than the next key
+        // and the tree is searched only when the next key is beyond the hint
+        // changes out of order or repeated are searched from scratch
+        IniValues::iterator hint = m_values.begin();
+        for (const change& c : changes) {
+            if ((hint != m_values.end() && hint->first < c.key)
+                || (hint != m_values.begin() && !(prev(hint)->first < c.key)))
+                hint = m_values.lower_bound(c.key);
+
+            bool bFound = hint != m_values.end() && hint->first == c.key;
+
+            recordEdit(c.key.str());
+
+            if (c.type == change::removed) {
+                if (bFound)
+                    hint = m_values.erase(hint);
+                continue;
+            }
+
+            if (bFound)
+                hint->second = intern(c.value);
+            else
+                hint = m_values.emplace_hint(hint, intern(c.key), intern(c.value));
+            ++hint;
+        }
+    } catch (const bad_alloc& ex) {
+        logError(string("Unable to apply changes: ") + ex.what());
+        throw runtime_error("Unable to apply changes! Max capacity is " + to_string(max_size()));
+    }
+}
+
+void IniParser::setValue(const string& strKey, const string& strValue, const string& strSection) {
+
+    if (m_bFrozen)
+        throw logic_error("The parser is frozen, unable to set " + strKey);
+
+    // whatever is set must load back the same
+    if (!isKeyName(strKey.data(), strKey.length()))
+        throw invalid_argument("Invalid key " + strKey);
+    if (strValue.find_first_of("\r\n") != string::npos)
+        throw invalid_argument("Invalid value for " + strKey + ", line breaks cannot be written");
+    if (strSection.find_first_of("]\r\n") != string::npos || trim(strSection) != strSection)
+        throw invalid_argument("Invalid section " + strSection);
+
+    string strQualifiedKey = strSection.empty() ? strKey : strSection + OP_SECTION_KEY_CAT + strKey;
+
+    try {
+        IniString value = intern(trim(strValue));
+        recordEdit(strQualifiedKey);
+
+        IniValues::iterator it = m_values.lower_bound(strQualifiedKey);
+        if (it != m_values.end() && it->first == strQualifiedKey)
+            it->second = value;
+        else
+            m_values.emplace_hint(it, intern(strQualifiedKey), value);
+    } catch (const bad_alloc& ex) {
+        logError(string("Unable to set value: ") + ex.what());
+        throw runtime_error("Unable to set value! Max capacity is " + to_string(max_size()));
+    }
+}
+
+bool IniParser::removeKey(const string& strKey, const string& strSection) {
+
+    if (m_bFrozen)
+        throw logic_error("The parser is frozen, unable to remove " + strKey);
+
+    string strQualifiedKey = strSection.empty() ? strKey : strSection + OP_SECTION_KEY_CAT + strKey;
+
+    // the key may still be in the source file even if it was not loaded
+    recordEdit(strQualifiedKey);
+
+    IniValues::iterator it = m_values.find(strQualifiedKey);
+    if (it == m_values.end())
+        return false;
+
+    m_values.erase(it);
+    return true;
+}
+
+void IniParser::writeToFile(const string& strFileName) const {
+
+    if (m_bFrozen)
+        throw logic_error("The parser is frozen, unable to write " + strFileName);
+
+    // a file replaced keeps its permissions
+    struct stat status;
+    IniWriter writer(strFileName, stat(strFileName.c_str(), &status) == 0 ? status.st_mode & 07777 : 0644);
+
+    // the map is sorted by qualified key, but a section's keys may be interleaved with its subsections' keys
+    map<string, vector<IniValues::const_iterator>> sections;
+
+    // sections are separated from the lines before them by a blank line
+    bool bWritten = false;
+    for (IniValues::const_iterator it = m_values.begin(); it != m_values.end(); ++it) {
+        const char* pKey = it->first.data();
+        const char* pSeparator = pKey + it->first.length();
+        while (pSeparator != pKey && *(pSeparator - 1) != OP_SECTION_KEY_CAT)
+            pSeparator--;
+
+        if (pSeparator == pKey) {
+            writer.copy(pKey, it->first.length());
+            writer.copy(" = ", 3);
+            writer.reference(it->second.data(), it->second.length());
+            writer.copy("\n", 1);
+            bWritten = true;
+        } else {
+            sections[string(pKey, pSeparator - 1)].push_back(it);
+        }
+    }
+
+    for (auto& section : sections) {
+        writer.copy(bWritten ? "\n" OP_SECTION_START : OP_SECTION_START);
+        writer.copy(section.first);
+        writer.copy(OP_SECTION_END "\n");
+        bWritten = true;
+
+        size_t nPrefix = section.first.length() + 1;
+        for (IniValues::const_iterator it : section.second) {
+            writer.copy(it->first.data() + nPrefix, it->first.length() - nPrefix);
+            writer.copy(" = ", 3);
+            writer.reference(it->second.data(), it->second.length());
+            writer.copy("\n", 1);
+        }
+    }
+
+    writer.commit();
+}
+
+void IniParser::writeToFile(const string& strFileName, const string& strSourceFile) const {
+
+    if (m_bFrozen)
+        throw logic_error("The parser is frozen, unable to write " + strFileName);
+
+    int nFd = open(strSourceFile.c_str(), O_RDONLY);
+    if (nFd < 0)
+        throw invalid_argument("Unable to open the source file " + strSourceFile + ": " + strerror(errno));
+
+    struct stat status;
+    if (fstat(nFd, &status) != 0) {
+        close(nFd);
+        throw invalid_argument("Unable to open the source file " + strSourceFile + ": " + strerror(errno));
+    }
+
+    // the source is mapped, so untouched ranges go to the output without being copied
+    size_t nSize = status.st_size;
+    void* pMapping = nullptr;
+    if (nSize > 0) {
+        pMapping = mmap(nullptr, nSize, PROT_READ, MAP_PRIVATE, nFd, 0);
+        if (pMapping == MAP_FAILED) {
+            close(nFd);
+            throw invalid_argument("Unable to map the source file " + strSourceFile + ": " + strerror(errno));
+        }
+        madvise(pMapping, nSize, MADV_SEQUENTIAL);
+    }
+    close(nFd);
+
+    // the mapping stays valid even when the output replaces the source
+    unique_ptr<void, function<void(void*)>> mapping(pMapping, [nSize](void* p) { munmap(p, nSize); });
+    const char* pSource = static_cast<const char*>(pMapping);
+
+    if (nSize >= 2 && static_cast<unsigned char>(pSource[0]) == 0x1f && static_cast<unsigned char>(pSource[1]) == 0x8b)
+        throw invalid_argument("Unable to write edits into the compressed file " + strSourceFile);
+
+    // the output gets the permissions of the source
+    IniWriter writer(strFileName, status.st_mode & 07777);
+    writeEdits(writer, pSource, nSize);
+    writer.commit();
+}
+
+string IniParser::getValue(const string &strKey, const string &strSection) const {
 
     if (strKey.empty())
         throw invalid_argument("The find key is empty!");
 
+    // the frozen table hashes section and key in place, no need to concatenate them
+    if (m_bFrozen) {
+        string strValue;
+        if (!m_frozenValues.find(strKey, strSection, strValue))
+            throw IniParser::no_such_key_exception();
+
+        return strValue;
+    }
+
     string strFindKey = strKey;
 
     if (!strSection.empty())
         strFindKey = strSection + OP_SECTION_KEY_CAT + strFindKey;
 
-    map<string, string>::const_iterator it = m_values.find(strFindKey);
+    IniValues::const_iterator it = m_values.find(strFindKey);
     if (it == m_values.end())
         throw IniParser::no_such_key_exception();
 
-    return it->second;
+    return it->second.str();
 }
 
 void IniParser::handleSection(const string &strSection) {
@@ -192,9 +637,30 @@ void IniParser::handleSection(const string &strSection) {
 
     // remove the [ ] and trim once again
     m_strCurrentSection = trim(strSection.substr(1, strSection.length() - 2));
+    filterSection();
 }
 
-void IniParser::handleKeyValueAssigment(const string &strKeyValueAssigment) {
+void IniParser::filterSection() {
+
+    m_bKeepSection = m_loadFilter.acceptsWholeSection(m_strCurrentSection);
+    m_bSkipSection = !m_bKeepSection && !m_loadFilter.acceptsSection(m_strCurrentSection);
+
+    if (m_bSkipSection)
+        logInfo("skipping section: " + m_strCurrentSection);
+}
+
+bool IniParser::peekSection(istream& is) {
+
+    int c = is.peek();
+    while (c == ' ' || c == '\t') {
+        is.get();
+        c = is.peek();
+    }
+
+    return c == OP_SECTION_START[0];
+}
+
+void IniParser::handleKeyValueAssigment(const string &strKeyValueAssigment, vector<pair<string, string>>& staged) {
 
     unsigned int pos = strKeyValueAssigment.find(OP_ASSIGN);
 
@@ -206,18 +672,196 @@ void IniParser::handleKeyValueAssigment(const string &strKeyValueAssigment) {
     if (!m_strCurrentSection.empty())
         key = m_strCurrentSection + OP_SECTION_KEY_CAT + key;
 
+    if (!m_bKeepSection && !m_loadFilter.acceptsKey(key)) {
+        logInfo("filtered key: " + key);
+        return;
+    }
+
+    staged.emplace_back(move(key), move(value));
+}
+
+void IniParser::mergeStaged(const vector<pair<string, string>>& staged) {
+
+    // sort indices rather than the strings themselves, equal keys keep their file order so the last one wins
+    vector<size_t> order(staged.size());
+    for (size_t i = 0; i < order.size(); i++)
+        order[i] = i;
+    sortStaged(staged, order.data(), order.size(), 0);
+
+    // undo log, so a failure in the middle leaves the values as they were - strong guarantee
+    // the rollback only erases nodes and swaps handles, it cannot fail
+    vector<IniValues::iterator> inserted;
+    vector<pair<IniValues::iterator, IniString>> overwritten;
+
 	try	{
-    	// insert or overwrite - throws "an exception" if the insert fails
-		// the documentation is quite vague and it doesn't say what exception is thrown.
-		// catching const reference to exception to prevent slicing
-		// throw a runtime error with verbose details, so the user can gracefully handle this
-	    m_values[key] = value;
+        inserted.reserve(staged.size());
+
+        // the keys come sorted, so the elements before the hint are always less than the next key
+        IniValues::iterator hint = m_values.begin();
+        for (size_t i = 0; i < order.size(); i++) {
+            const pair<string, string>& entry = staged[order[i]];
+
+            // skip all but the last writer
+            if (i + 1 < order.size() && entry.first == staged[order[i + 1]].first)
+                continue;
+
+            if (hint != m_values.end() && hint->first < entry.first)
+                hint = m_values.lower_bound(entry.first);
+
+            if (hint != m_values.end() && !(entry.first < hint->first)) {
+                overwritten.emplace_back(hint, intern(entry.second));
+                swap(hint->second, overwritten.back().second);
+            } else {
+                hint = m_values.emplace_hint(hint, intern(entry.first), intern(entry.second));
+                inserted.push_back(hint);
+            }
+            ++hint;
+        }
 	} catch (const exception& ex) {
+        for (auto& it : overwritten)
+            swap(it.first->second, it.second);
+        for (auto& it : inserted)
+            m_values.erase(it);
+
 		logError(string("Unable to insert values into map") + ex.what());
-		throw runtime_error("Unable to load values! Max capacity is " + max_size());
+		throw runtime_error("Unable to load values! Max capacity is " + to_string(max_size()));
 	}
 }
 
+void IniParser::writeEdits(IniWriter& writer, const char* pSource, size_t nSize) const {
+
+    // a splice replaces a range of the source with some text
+    struct Splice {
+        size_t nOffset;
+        size_t nLength;
+        string strText;
+    };
+    vector<Splice> splices;
+
+    // holds the edited keys found in the source, by section
+    map<string, set<string>> found;
+
+    // holds where the last block of each edited section ends, new keys go there
+    map<string, size_t> sectionEnds;
+
+    // holds the end of the last line of the current block that is neither blank nor a comment
+    // comments before the next header belong to the next section
+    size_t nBlockEnd = string::npos;
+
+    string strSection;
+    map<string, set<string>>::const_iterator itEdits = m_edits.find(strSection);
+
+    size_t nLine = 0;
+    while (nLine < nSize) {
+        const char* pLine = pSource + nLine;
+        const char* pBreak = static_cast<const char*>(memchr(pLine, '\n', nSize - nLine));
+        const char* e = pBreak ? pBreak : pSource + nSize;
+        size_t nNext = pBreak ? pBreak - pSource + 1 : nSize;
+
+        const char* p = pLine;
+        while (p < e && isspace(static_cast<unsigned char>(*p)))
+            p++;
+
+        string strHeader;
+        if (parseSectionHeader(p, e, strHeader)) {
+            if (itEdits != m_edits.end())
+                sectionEnds[strSection] = nBlockEnd != string::npos ? nBlockEnd : nLine;
+
+            strSection = trim(strHeader);
+            itEdits = m_edits.find(strSection);
+            nBlockEnd = nNext;
+            nLine = nNext;
+            continue;
+        }
+
+        if (p < e && *p != OP_COMMENT1 && *p != OP_COMMENT2)
+            nBlockEnd = nNext;
+
+        if (itEdits != m_edits.end()) {
+            // only the lines of edited sections are parsed
+            const char* pKey = p;
+            while (p < e && (isalnum(static_cast<unsigned char>(*p)) || *p == '_'))
+                p++;
+            string strKey(pKey, p);
+            while (p < e && isspace(static_cast<unsigned char>(*p)))
+                p++;
+
+            // the same rule as the key value regex: no carriage return in the value, so "x = 1\r\n" is not a key line
+            if (p < e && *p == OP_ASSIGN && !memchr(p, '\r', e - p)
+                && isKeyName(strKey.data(), strKey.length()) && itEdits->second.count(strKey)) {
+                found[strSection].insert(strKey);
+
+                string strQualifiedKey = strSection.empty() ? strKey : strSection + OP_SECTION_KEY_CAT + strKey;
+                IniValues::const_iterator it = m_values.find(strQualifiedKey);
+                if (it != m_values.end())
+                    splices.push_back(Splice{ static_cast<size_t>(pKey - pSource), static_cast<size_t>(e - pKey), strKey + " = " + it->second.str() });
+                else
+                    splices.push_back(Splice{ nLine, nNext - nLine, string() });
+            }
+        }
+
+        nLine = nNext;
+    }
+
+    if (itEdits != m_edits.end())
+        sectionEnds[strSection] = nBlockEnd != string::npos ? nBlockEnd : nSize;
+
+    // keys not found in the source go at the end of their section, new sections at the end of the file
+    string strNewSections;
+    for (auto& edits : m_edits) {
+        const set<string>& keys = found[edits.first];
+
+        string strLines;
+        for (const string& strKey : edits.second) {
+            if (keys.count(strKey))
+                continue;
+
+            string strQualifiedKey = edits.first.empty() ? strKey : edits.first + OP_SECTION_KEY_CAT + strKey;
+            IniValues::const_iterator it = m_values.find(strQualifiedKey);
+            if (it != m_values.end())
+                strLines += strKey + " = " + it->second.str() + '\n';
+        }
+
+        if (strLines.empty())
+            continue;
+
+        map<string, size_t>::const_iterator itEnd = sectionEnds.find(edits.first);
+        if (itEnd != sectionEnds.end())
+            splices.push_back(Splice{ itEnd->second, 0, strLines });
+        else
+            strNewSections += "\n" OP_SECTION_START + edits.first + OP_SECTION_END "\n" + strLines;
+    }
+
+    if (!strNewSections.empty())
+        splices.push_back(Splice{ nSize, 0, strNewSections });
+
+    // insertions go before replacements at the same offset and keep their order, so the new sections stay last
+    stable_sort(splices.begin(), splices.end(), [](const Splice& a, const Splice& b) {
+        return a.nOffset < b.nOffset || (a.nOffset == b.nOffset && a.nLength == 0 && b.nLength != 0);
+    });
+
+    size_t nOffset = 0;
+    char cLast = '\n';
+    for (const Splice& splice : splices) {
+        if (splice.nOffset > nOffset) {
+            writer.reference(pSource + nOffset, splice.nOffset - nOffset);
+            cLast = pSource[splice.nOffset - 1];
+        }
+
+        // text appended to a file without a final line break needs one first
+        if (splice.nLength == 0 && cLast != '\n')
+            writer.copy("\n", 1);
+
+        writer.copy(splice.strText);
+        if (!splice.strText.empty())
+            cLast = splice.strText.back();
+        nOffset = splice.nOffset + splice.nLength;
+    }
+
+    if (nOffset < nSize)
+        writer.reference(pSource + nOffset, nSize - nOffset);
+}
+
 string IniParser::trim(const string &s) {
 
     string::const_iterator lit = s.begin();
@@ -236,7 +880,7 @@ void IniParser::logValues() {
 #ifdef DEBUG
     clog << m_values.size() << " values:\n";
     for (auto it = m_values.begin(); it != m_values.end(); ++it)
-        clog << it->first << " = " << it->second << '\n';
+        clog << it->first.str() << " = " << it->second.str() << '\n';
 #endif
 }
 
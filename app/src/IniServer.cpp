@@ -0,0 +1,297 @@
+#include <iostream>
+#include <stdexcept>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/stat.h>
+
+#include "IniServer.h"
+
+using namespace std;
+
+#define OP_SECTION_KEY_CAT      '.'
+
+// bytes read at once from a connection
+#define SERVER_READ_SIZE        (64 * 1024)
+// stop reading from a connection while it has that many answers not sent yet
+#define SERVER_MAX_PENDING      (1024 * 1024)
+
+#define SERVER_CMD_STOP         's'
+#define SERVER_CMD_RELOAD       'r'
+
+// makes a file descriptor non blocking
+static void setNonBlocking(int fd) {
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+}
+
+// removes a socket left by a server that is gone - never a file, never a socket a server listens on
+static void removeStaleSocket(const sockaddr_un& address) {
+
+    const string strSocketPath = address.sun_path;
+
+    struct stat status;
+    if (lstat(address.sun_path, &status) != 0) {
+        if (errno == ENOENT)
+            return;
+        throw runtime_error("Unable to listen on " + strSocketPath + ": " + strerror(errno));
+    }
+
+    if (!S_ISSOCK(status.st_mode))
+        throw runtime_error("Unable to listen on " + strSocketPath + ": the path exists and it is not a socket");
+
+    int nFd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (nFd < 0)
+        throw runtime_error("Unable to listen on " + strSocketPath + ": " + strerror(errno));
+    int nResult = connect(nFd, reinterpret_cast<const sockaddr*>(&address), sizeof(address));
+    int nError = errno;
+    close(nFd);
+
+    if (nResult == 0)
+        throw runtime_error("Unable to listen on " + strSocketPath + ": another server listens there");
+    if (nError != ECONNREFUSED)
+        throw runtime_error("Unable to listen on " + strSocketPath + ": " + strerror(nError));
+
+    unlink(address.sun_path);
+}
+
+IniServer::IniServer(const string& strSocketPath, const vector<string>& files)
+    : m_strSocketPath(strSocketPath),
+      m_files(files),
+      m_nListenFd(-1)
+{
+    m_parser = load();
+
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    if (strSocketPath.empty() || strSocketPath.length() >= sizeof(address.sun_path))
+        throw invalid_argument("Invalid socket path " + strSocketPath);
+    strncpy(address.sun_path, strSocketPath.c_str(), sizeof(address.sun_path) - 1);
+
+    removeStaleSocket(address);
+
+    if (pipe(m_wakeFds) != 0)
+        throw runtime_error(string("Unable to create the wake up pipe: ") + strerror(errno));
+    setNonBlocking(m_wakeFds[0]);
+    setNonBlocking(m_wakeFds[1]);
+
+    m_nListenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (m_nListenFd < 0
+        || bind(m_nListenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0
+        || listen(m_nListenFd, SOMAXCONN) != 0) {
+        string strError = strerror(errno);
+        if (m_nListenFd >= 0)
+            close(m_nListenFd);
+        close(m_wakeFds[0]);
+        close(m_wakeFds[1]);
+        throw runtime_error("Unable to listen on " + strSocketPath + ": " + strError);
+    }
+    setNonBlocking(m_nListenFd);
+}
+
+IniServer::~IniServer() {
+
+    for (Connection& connection : m_connections)
+        close(connection.fd);
+
+    close(m_nListenFd);
+    unlink(m_strSocketPath.c_str());
+
+    close(m_wakeFds[0]);
+    close(m_wakeFds[1]);
+}
+
+unique_ptr<IniParser> IniServer::load() const {
+
+    unique_ptr<IniParser> parser(new IniParser(true));
+    for (const string& strFileName : m_files)
+        parser->updateFromFile(strFileName);
+
+    // the values are read only from now on
+    parser->freeze();
+    return parser;
+}
+
+void IniServer::run() {
+
+    vector<pollfd> fds;
+
+    for (;;) {
+        fds.clear();
+        fds.push_back(pollfd{ m_wakeFds[0], POLLIN, 0 });
+        fds.push_back(pollfd{ m_nListenFd, POLLIN, 0 });
+        for (const Connection& connection : m_connections) {
+            short events = connection.strOut.size() < SERVER_MAX_PENDING ? POLLIN : 0;
+            if (!connection.strOut.empty())
+                events |= POLLOUT;
+            fds.push_back(pollfd{ connection.fd, events, 0 });
+        }
+
+        if (poll(fds.data(), fds.size(), -1) < 0) {
+            if (errno == EINTR)
+                continue;
+            throw runtime_error(string("Unable to poll: ") + strerror(errno));
+        }
+
+        // commands
+        if (fds[0].revents & POLLIN) {
+            char commands[64];
+            ssize_t nRead;
+            bool bReload = false;
+            while ((nRead = read(m_wakeFds[0], commands, sizeof(commands))) > 0) {
+                for (ssize_t i = 0; i < nRead; i++) {
+                    if (commands[i] == SERVER_CMD_STOP)
+                        return;
+                    bReload = bReload || commands[i] == SERVER_CMD_RELOAD;
+                }
+            }
+
+            if (bReload) {
+                try {
+                    m_parser = load();
+                } catch (const exception& ex) {
+                    cerr << "Unable to reload, keeping the current values: " << ex.what() << endl;
+                }
+            }
+        }
+
+        // connections accepted during this round are polled in the next one
+        size_t nConnections = m_connections.size();
+
+        if (fds[1].revents & POLLIN) {
+            int fd;
+            while ((fd = accept(m_nListenFd, nullptr, nullptr)) >= 0) {
+                setNonBlocking(fd);
+                m_connections.push_back(Connection{ fd, false, string(), string() });
+            }
+        }
+
+        // serve, then drop the closed connections
+        size_t nKept = 0;
+        for (size_t i = 0; i < m_connections.size(); i++) {
+            Connection& connection = m_connections[i];
+            short revents = i < nConnections ? fds[i + 2].revents : 0;
+
+            bool bKeep = true;
+            if (revents & (POLLIN | POLLHUP | POLLERR))
+                bKeep = receive(connection);
+            if (bKeep && !connection.strOut.empty())
+                bKeep = send(connection);
+            bKeep = bKeep && !connection.bClosed;
+
+            if (!bKeep) {
+                close(connection.fd);
+                continue;
+            }
+
+            if (nKept != i)
+                m_connections[nKept] = move(connection);
+            nKept++;
+        }
+        m_connections.resize(nKept);
+    }
+}
+
+void IniServer::stop() {
+    wakeUp(SERVER_CMD_STOP);
+}
+
+void IniServer::reload() {
+    wakeUp(SERVER_CMD_RELOAD);
+}
+
+void IniServer::wakeUp(char command) {
+
+    // a full pipe already holds a pending command, losing this one is harmless for reloads
+    ssize_t nWritten = write(m_wakeFds[1], &command, 1);
+    (void)nWritten;
+}
+
+bool IniServer::receive(Connection& connection) {
+
+    char buffer[SERVER_READ_SIZE];
+    for (;;) {
+        ssize_t nRead = recv(connection.fd, buffer, sizeof(buffer), 0);
+        if (nRead > 0) {
+            connection.strIn.append(buffer, nRead);
+            if (nRead < static_cast<ssize_t>(sizeof(buffer)))
+                break;
+            continue;
+        }
+        if (nRead < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            break;
+        if (nRead < 0 && errno == EINTR)
+            continue;
+
+        // closed by the client, the requests received so far are still answered
+        if (nRead == 0) {
+            connection.bClosed = true;
+            break;
+        }
+
+        return false;
+    }
+
+    // answer all the complete requests, pipelined requests are answered in a single write
+    size_t nOffset = 0;
+    while (connection.strIn.size() - nOffset >= sizeof(uint32_t)) {
+        uint32_t nLength;
+        memcpy(&nLength, connection.strIn.data() + nOffset, sizeof(nLength));
+        if (nLength > INI_PROTOCOL_MAX_REQUEST)
+            return false;
+        if (connection.strIn.size() - nOffset - sizeof(nLength) < nLength)
+            break;
+
+        answer(connection.strIn.data() + nOffset + sizeof(nLength), nLength, connection.strOut);
+        nOffset += sizeof(nLength) + nLength;
+    }
+    connection.strIn.erase(0, nOffset);
+
+    return true;
+}
+
+bool IniServer::send(Connection& connection) {
+
+    while (!connection.strOut.empty()) {
+        ssize_t nWritten = ::send(connection.fd, connection.strOut.data(), connection.strOut.size(), MSG_NOSIGNAL);
+        if (nWritten > 0) {
+            connection.strOut.erase(0, nWritten);
+            continue;
+        }
+        if (nWritten < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            return true;
+        if (nWritten < 0 && errno == EINTR)
+            continue;
+
+        return false;
+    }
+
+    return true;
+}
+
+void IniServer::answer(const char* pKey, size_t nLength, string& strOut) const {
+
+    // keys cannot hold dots, so the last one splits the section from the key
+    string strQualifiedKey(pKey, nLength);
+    size_t pos = strQualifiedKey.rfind(OP_SECTION_KEY_CAT);
+    string strSection = pos == string::npos ? "" : strQualifiedKey.substr(0, pos);
+    string strKey = pos == string::npos ? strQualifiedKey : strQualifiedKey.substr(pos + 1);
+
+    uint8_t nStatus = INI_PROTOCOL_FOUND;
+    string strValue;
+    try {
+        strValue = m_parser->getValueT<string>(strKey, strSection);
+    } catch (const IniParser::no_such_key_exception& ex) {
+        nStatus = INI_PROTOCOL_NO_SUCH_KEY;
+    } catch (const invalid_argument& ex) {
+        nStatus = INI_PROTOCOL_NO_SUCH_KEY;
+    }
+
+    uint32_t nValueLength = static_cast<uint32_t>(strValue.length());
+    strOut.append(reinterpret_cast<const char*>(&nStatus), sizeof(nStatus));
+    strOut.append(reinterpret_cast<const char*>(&nValueLength), sizeof(nValueLength));
+    strOut.append(strValue);
+}
@@ -0,0 +1,118 @@
+#include <stdexcept>
+#include <cstring>
+#include <cerrno>
+#include <climits>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "IniSharedPublisher.h"
+
+using namespace std;
+
+// room left in the name for the generation suffix
+#define SHARED_SUFFIX_LENGTH    11
+
+IniSharedPublisher::IniSharedPublisher(const string& strName)
+    : m_strName(strName),
+      m_pControl(nullptr)
+{
+    if (!isValidName(strName))
+        throw invalid_argument("Invalid shared memory name " + strName);
+
+    int nFd = shm_open(strName.c_str(), O_CREAT | O_RDWR, 0644);
+    if (nFd < 0)
+        throw runtime_error("Unable to create the shared memory " + strName + ": " + strerror(errno));
+
+    // a new segment is empty, an existing one must hold a control block
+    struct stat status;
+    bool bValid = fstat(nFd, &status) == 0
+        && (status.st_size == 0 || status.st_size >= static_cast<off_t>(sizeof(IniSharedControl)))
+        && (status.st_size != 0 || ftruncate(nFd, sizeof(IniSharedControl)) == 0);
+
+    void* pControl = bValid ? mmap(nullptr, sizeof(IniSharedControl), PROT_READ | PROT_WRITE, MAP_SHARED, nFd, 0) : MAP_FAILED;
+    string strError = strerror(errno);
+    close(nFd);
+
+    if (pControl == MAP_FAILED)
+        throw runtime_error("Unable to map the shared memory " + strName + (bValid ? ": " + strError : ""));
+
+    m_pControl = static_cast<IniSharedControl*>(pControl);
+    if (m_pControl->nMagic != INI_SHARED_MAGIC && m_pControl->nMagic != 0) {
+        munmap(m_pControl, sizeof(IniSharedControl));
+        throw runtime_error("The shared memory " + strName + " holds something else");
+    }
+    m_pControl->nMagic = INI_SHARED_MAGIC;
+}
+
+IniSharedPublisher::~IniSharedPublisher() {
+    munmap(m_pControl, sizeof(IniSharedControl));
+}
+
+void IniSharedPublisher::publish(const IniParser& parser) {
+
+    // the image is written from a frozen table, built here if the parser is not frozen
+    IniFrozenTable table;
+    const IniFrozenTable* pTable = &parser.m_frozenValues;
+    if (!parser.m_bFrozen) {
+        table.build(parser.m_values);
+        pTable = &table;
+    }
+
+    uint32_t nPrevious = m_pControl->nGeneration.load(memory_order_relaxed);
+    uint32_t nGeneration = nPrevious + 1 != 0 ? nPrevious + 1 : 1;
+    string strSegmentName = segmentName(m_strName, nGeneration);
+
+    // a segment left by a publisher that died before publishing it was never seen by readers
+    int nFd = shm_open(strSegmentName.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (nFd < 0 && errno == EEXIST) {
+        shm_unlink(strSegmentName.c_str());
+        nFd = shm_open(strSegmentName.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    }
+    if (nFd < 0)
+        throw runtime_error("Unable to create the shared memory " + strSegmentName + ": " + strerror(errno));
+
+    size_t nSize = sizeof(IniSharedHeader) + pTable->imageSize();
+    void* pSegment = ftruncate(nFd, nSize) == 0 ? mmap(nullptr, nSize, PROT_READ | PROT_WRITE, MAP_SHARED, nFd, 0) : MAP_FAILED;
+    string strError = strerror(errno);
+    close(nFd);
+
+    if (pSegment == MAP_FAILED) {
+        shm_unlink(strSegmentName.c_str());
+        throw runtime_error("Unable to map the shared memory " + strSegmentName + ": " + strError);
+    }
+
+    IniSharedHeader header = { INI_SHARED_MAGIC, nGeneration, pTable->imageSize() };
+    memcpy(pSegment, &header, sizeof(header));
+    pTable->writeImage(static_cast<char*>(pSegment) + sizeof(header));
+    munmap(pSegment, nSize);
+
+    // the segment is complete before readers can see its generation
+    m_pControl->nGeneration.store(nGeneration, memory_order_release);
+
+    // readers still on the previous generation keep their mapping
+    if (nPrevious != 0)
+        shm_unlink(segmentName(m_strName, nPrevious).c_str());
+}
+
+uint32_t IniSharedPublisher::generation() const {
+    return m_pControl->nGeneration.load(memory_order_relaxed);
+}
+
+void IniSharedPublisher::unlink() {
+
+    uint32_t nGeneration = m_pControl->nGeneration.load(memory_order_relaxed);
+    if (nGeneration != 0)
+        shm_unlink(segmentName(m_strName, nGeneration).c_str());
+    shm_unlink(m_strName.c_str());
+}
+
+bool IniSharedPublisher::isValidName(const string& strName) {
+    return strName.length() > 1 && strName.length() + SHARED_SUFFIX_LENGTH < NAME_MAX
+        && strName[0] == '/' && strName.find('/', 1) == string::npos;
+}
+
+string IniSharedPublisher::segmentName(const string& strName, uint32_t nGeneration) {
+    return strName + '.' + to_string(nGeneration);
+}
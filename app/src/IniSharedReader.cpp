@@ -0,0 +1,112 @@
+#include <stdexcept>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "IniSharedReader.h"
+
+using namespace std;
+
+IniSharedReader::IniSharedReader(const string& strName)
+    : m_strName(strName),
+      m_pControl(nullptr),
+      m_nGeneration(0),
+      m_pSegment(nullptr),
+      m_nSegmentSize(0)
+{
+    if (!IniSharedPublisher::isValidName(strName))
+        throw invalid_argument("Invalid shared memory name " + strName);
+
+    int nFd = shm_open(strName.c_str(), O_RDONLY, 0);
+    if (nFd < 0)
+        throw runtime_error("Unable to open the shared memory " + strName + ": " + strerror(errno));
+
+    struct stat status;
+    bool bValid = fstat(nFd, &status) == 0 && status.st_size >= static_cast<off_t>(sizeof(IniSharedControl));
+    void* pControl = bValid ? mmap(nullptr, sizeof(IniSharedControl), PROT_READ, MAP_SHARED, nFd, 0) : MAP_FAILED;
+    close(nFd);
+
+    if (pControl == MAP_FAILED)
+        throw runtime_error("Unable to map the shared memory " + strName);
+    m_pControl = static_cast<const IniSharedControl*>(pControl);
+
+    try {
+        if (m_pControl->nMagic != INI_SHARED_MAGIC || m_pControl->nGeneration.load(memory_order_acquire) == 0)
+            throw runtime_error("Nothing was published into the shared memory " + strName);
+        refresh();
+    } catch (...) {
+        munmap(const_cast<IniSharedControl*>(m_pControl), sizeof(IniSharedControl));
+        throw;
+    }
+}
+
+IniSharedReader::~IniSharedReader() {
+
+    if (m_pSegment)
+        munmap(const_cast<char*>(m_pSegment), m_nSegmentSize);
+    munmap(const_cast<IniSharedControl*>(m_pControl), sizeof(IniSharedControl));
+}
+
+bool IniSharedReader::find(const string& strKey, const string& strSection, string& strValue) {
+
+    refresh();
+    return IniFrozenTable::find(m_pSegment + sizeof(IniSharedHeader), strKey, strSection, strValue);
+}
+
+uint32_t IniSharedReader::generation() const {
+    return m_nGeneration;
+}
+
+void IniSharedReader::refresh() {
+
+    // the common case - a single load from a cache line that is written only by publications
+    uint32_t nGeneration = m_pControl->nGeneration.load(memory_order_acquire);
+    if (nGeneration == m_nGeneration)
+        return;
+
+    // the publisher removes a generation as soon as the next one is published, follow it
+    string strSegmentName;
+    int nFd;
+    for (;;) {
+        strSegmentName = IniSharedPublisher::segmentName(m_strName, nGeneration);
+        nFd = shm_open(strSegmentName.c_str(), O_RDONLY, 0);
+        if (nFd >= 0 || errno != ENOENT)
+            break;
+
+        uint32_t nLatest = m_pControl->nGeneration.load(memory_order_acquire);
+        if (nLatest == nGeneration)
+            break;
+        nGeneration = nLatest;
+    }
+
+    if (nFd < 0)
+        throw runtime_error("Unable to open the shared memory " + strSegmentName + ": " + strerror(errno));
+
+    struct stat status;
+    bool bValid = fstat(nFd, &status) == 0 && status.st_size >= static_cast<off_t>(sizeof(IniSharedHeader));
+    size_t nSize = bValid ? status.st_size : 0;
+    void* pSegment = bValid ? mmap(nullptr, nSize, PROT_READ, MAP_SHARED, nFd, 0) : MAP_FAILED;
+    close(nFd);
+
+    if (pSegment == MAP_FAILED)
+        throw runtime_error("Unable to map the shared memory " + strSegmentName);
+
+    // the segment comes from another process, check it before trusting its offsets
+    const IniSharedHeader* pHeader = static_cast<const IniSharedHeader*>(pSegment);
+    const char* pImage = static_cast<const char*>(pSegment) + sizeof(IniSharedHeader);
+    if (pHeader->nMagic != INI_SHARED_MAGIC || pHeader->nGeneration != nGeneration
+        || pHeader->nImageSize > nSize - sizeof(IniSharedHeader) || !IniFrozenTable::isImage(pImage, pHeader->nImageSize)) {
+        munmap(pSegment, nSize);
+        throw runtime_error("The shared memory " + strSegmentName + " is corrupted");
+    }
+
+    if (m_pSegment)
+        munmap(const_cast<char*>(m_pSegment), m_nSegmentSize);
+
+    m_pSegment = static_cast<const char*>(pSegment);
+    m_nSegmentSize = nSize;
+    m_nGeneration = nGeneration;
+}
@@ -0,0 +1,181 @@
+#include <new>
+#include <cstddef>
+
+#include "IniStringPool.h"
+
+using namespace std;
+
+#define FNV_OFFSET              0xcbf29ce484222325ull
+#define FNV_PRIME               0x100000001b3ull
+
+IniString::IniString()
+    : m_node(emptyNode())
+{
+}
+
+IniString::IniString(const string& s)
+    : m_node(s.empty() ? emptyNode() : allocate(s.data(), s.length(), nullptr))
+{
+}
+
+IniString::IniString(const IniString& other)
+    : m_node(other.m_node)
+{
+    acquire();
+}
+
+IniString::IniString(IniString&& other)
+    : m_node(other.m_node)
+{
+    other.m_node = emptyNode();
+}
+
+IniString& IniString::operator=(const IniString& other) {
+
+    if (m_node != other.m_node) {
+        release();
+        m_node = other.m_node;
+        acquire();
+    }
+
+    return *this;
+}
+
+IniString& IniString::operator=(IniString&& other) {
+
+    if (this != &other) {
+        release();
+        m_node = other.m_node;
+        other.m_node = emptyNode();
+    }
+
+    return *this;
+}
+
+IniString::~IniString() {
+    release();
+}
+
+IniString::Node* IniString::allocate(const char* p, size_t n, IniStringPool* pool) {
+
+    if (n > UINT32_MAX)
+        throw length_error("The string is too long!");
+
+    Node* node = static_cast<Node*>(::operator new(offsetof(Node, data) + n + 1));
+    new (&node->refs) atomic<uint32_t>(1);
+    node->length = static_cast<uint32_t>(n);
+    node->pool = pool;
+    memcpy(node->data, p, n);
+    node->data[n] = '\0';
+
+    return node;
+}
+
+void IniString::destroy(Node* node) {
+
+    node->refs.~atomic<uint32_t>();
+    ::operator delete(node);
+}
+
+IniString::Node* IniString::emptyNode() {
+
+    static Node node = { {1}, 0, nullptr, { '\0' } };
+    return &node;
+}
+
+void IniString::acquire() {
+
+    if (m_node != emptyNode())
+        m_node->refs.fetch_add(1, memory_order_relaxed);
+}
+
+void IniString::release() {
+
+    if (m_node == emptyNode())
+        return;
+
+    if (m_node->refs.fetch_sub(1, memory_order_acq_rel) != 1)
+        return;
+
+    if (m_node->pool)
+        m_node->pool->release(m_node);
+    else
+        destroy(m_node);
+}
+
+shared_ptr<IniStringPool> IniStringPool::create() {
+    return shared_ptr<IniStringPool>(new IniStringPool());
+}
+
+size_t IniStringPool::Hash::operator()(const Key& key) const {
+
+    uint64_t h = FNV_OFFSET;
+    for (size_t i = 0; i < key.length; i++) {
+        h ^= static_cast<unsigned char>(key.data[i]);
+        h *= FNV_PRIME;
+    }
+
+    return static_cast<size_t>(h);
+}
+
+IniString IniStringPool::intern(const string& s) {
+
+    if (s.empty())
+        return IniString();
+
+    lock_guard<mutex> lock(m_mutex);
+
+    auto it = m_strings.find(Key{ s.data(), s.length() });
+    if (it != m_strings.end()) {
+        IniString::Node* node = it->second;
+
+        // share the string unless its last handle is being released right now
+        // a released string is never revived, so it is freed exactly once
+        uint32_t nRefs = node->refs.load(memory_order_relaxed);
+        while (nRefs != 0) {
+            if (node->refs.compare_exchange_weak(nRefs, nRefs + 1, memory_order_relaxed))
+                return IniString(node);
+        }
+
+        // replace it, the pending release won't remove the new one, since it compares nodes
+        m_strings.erase(it);
+    }
+
+    IniString::Node* node = IniString::allocate(s.data(), s.length(), this);
+    try {
+        m_strings.emplace(Key{ node->data, node->length }, node);
+    } catch (...) {
+        IniString::destroy(node);
+        throw;
+    }
+
+    if (m_nNodes++ == 0)
+        m_self = shared_from_this();
+
+    return IniString(node);
+}
+
+size_t IniStringPool::size() const {
+
+    lock_guard<mutex> lock(m_mutex);
+    return m_strings.size();
+}
+
+void IniStringPool::release(IniString::Node* node) {
+
+    // destroyed last, after unlocking, since it may hold the last reference to the pool
+    shared_ptr<IniStringPool> self;
+
+    {
+        lock_guard<mutex> lock(m_mutex);
+
+        auto it = m_strings.find(Key{ node->data, node->length });
+        if (it != m_strings.end() && it->second == node)
+            m_strings.erase(it);
+
+        if (--m_nNodes == 0)
+            self.swap(m_self);
+    }
+
+    IniString::destroy(node);
+}
@@ -0,0 +1,149 @@
+#include <stdexcept>
+#include <cstring>
+#include <cerrno>
+#include <cstdio>
+#include <climits>
+#include <cstdlib>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "IniWriter.h"
+
+using namespace std;
+
+// appended to the target to name the temporary file, mkstemp replaces the X's
+#define WRITER_TEMP_SUFFIX      ".XXXXXX"
+// size of the buffer holding the small pieces
+#define WRITER_BUFFER_SIZE      (256 * 1024)
+// pieces smaller than this are copied, bigger ones are referenced
+#define WRITER_COPY_LIMIT       512
+// maximum number of pieces per writev
+#ifdef IOV_MAX
+#define WRITER_MAX_PIECES       IOV_MAX
+#else
+#define WRITER_MAX_PIECES       1024
+#endif
+
+IniWriter::IniWriter(const string& strFileName, mode_t nMode)
+    : m_strFileName(strFileName)
+{
+    if (strFileName.empty())
+        throw invalid_argument("The output file name is empty!");
+
+    // a unique name in the target's directory, so the rename stays on the same file system
+    // and concurrent writers or files already there are never overwritten
+    vector<char> name(strFileName.begin(), strFileName.end());
+    name.insert(name.end(), WRITER_TEMP_SUFFIX, WRITER_TEMP_SUFFIX + sizeof(WRITER_TEMP_SUFFIX));
+
+    m_nFd = mkstemp(name.data());
+    if (m_nFd < 0)
+        throw invalid_argument("Unable to create a temporary file for " + strFileName + ": " + strerror(errno));
+    m_strTempFileName = name.data();
+
+    // mkstemp creates the file readable by its owner only
+    if (fchmod(m_nFd, nMode) != 0) {
+        string strError = strerror(errno);
+        close(m_nFd);
+        unlink(m_strTempFileName.c_str());
+        throw invalid_argument("Unable to set the permissions of " + m_strTempFileName + ": " + strError);
+    }
+
+    m_buffer.reserve(WRITER_BUFFER_SIZE);
+    m_pieces.reserve(WRITER_MAX_PIECES);
+}
+
+IniWriter::~IniWriter() {
+
+    if (m_nFd >= 0) {
+        close(m_nFd);
+        unlink(m_strTempFileName.c_str());
+    }
+}
+
+void IniWriter::copy(const char* p, size_t n) {
+
+    if (n == 0)
+        return;
+
+    if (m_buffer.size() + n > m_buffer.capacity())
+        flush();
+
+    // too big for the buffer, write it right away
+    if (n > m_buffer.capacity()) {
+        m_pieces.push_back(iovec{ const_cast<char*>(p), n });
+        flush();
+        return;
+    }
+
+    // extend the last piece if it ends where the copy starts
+    // otherwise make room for a new piece first, flushing empties the buffer
+    char* pCopy = m_buffer.data() + m_buffer.size();
+    bool bExtend = !m_pieces.empty() && static_cast<char*>(m_pieces.back().iov_base) + m_pieces.back().iov_len == pCopy;
+    if (!bExtend && m_pieces.size() == WRITER_MAX_PIECES) {
+        flush();
+        pCopy = m_buffer.data();
+    }
+
+    m_buffer.insert(m_buffer.end(), p, p + n);
+
+    if (bExtend)
+        m_pieces.back().iov_len += n;
+    else
+        m_pieces.push_back(iovec{ pCopy, n });
+}
+
+void IniWriter::reference(const char* p, size_t n) {
+
+    if (n < WRITER_COPY_LIMIT) {
+        copy(p, n);
+        return;
+    }
+
+    if (m_pieces.size() == WRITER_MAX_PIECES)
+        flush();
+
+    m_pieces.push_back(iovec{ const_cast<char*>(p), n });
+}
+
+void IniWriter::flush() {
+
+    size_t nFirst = 0;
+    while (nFirst < m_pieces.size()) {
+        ssize_t nWritten = writev(m_nFd, m_pieces.data() + nFirst, m_pieces.size() - nFirst);
+        if (nWritten < 0 && errno == EINTR)
+            continue;
+        if (nWritten < 0)
+            throw runtime_error("Unable to write " + m_strTempFileName + ": " + strerror(errno));
+
+        // skip what was written, the last piece may be written partially
+        size_t nLeft = nWritten;
+        while (nFirst < m_pieces.size() && nLeft >= m_pieces[nFirst].iov_len)
+            nLeft -= m_pieces[nFirst++].iov_len;
+        if (nLeft > 0) {
+            m_pieces[nFirst].iov_base = static_cast<char*>(m_pieces[nFirst].iov_base) + nLeft;
+            m_pieces[nFirst].iov_len -= nLeft;
+        }
+    }
+
+    m_pieces.clear();
+    m_buffer.clear();
+}
+
+void IniWriter::commit() {
+
+    flush();
+
+    // the data must reach the disk before the rename makes it visible
+    if (fsync(m_nFd) != 0)
+        throw runtime_error("Unable to write " + m_strTempFileName + ": " + strerror(errno));
+
+    close(m_nFd);
+    m_nFd = -1;
+
+    if (rename(m_strTempFileName.c_str(), m_strFileName.c_str()) != 0) {
+        string strError = strerror(errno);
+        unlink(m_strTempFileName.c_str());
+        throw runtime_error("Unable to replace " + m_strFileName + ": " + strError);
+    }
+}
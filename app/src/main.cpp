@@ -1,11 +1,114 @@
 #include <iostream>
+#include <cstring>
+#include <csignal>
 
 #include "IniParser.h"
+#include "IniServer.h"
+#include "IniClient.h"
+#include "IniSharedPublisher.h"
 
 using namespace std;
 
+// the server answering the signals, only one per process
+static IniServer* g_pServer = nullptr;
+
+static void onSignal(int nSignal) {
+	if (!g_pServer)
+		return;
+
+	if (nSignal == SIGHUP)
+		g_pServer->reload();
+	else
+		g_pServer->stop();
+}
+
+// iniparser --serve <socket> <files...> - loads the files once and answers lookups, SIGHUP reloads the files
+static int serve(const string& strSocketPath, const vector<string>& files) {
+
+	try {
+		IniServer server(strSocketPath, files);
+
+		g_pServer = &server;
+		signal(SIGHUP, onSignal);
+		signal(SIGINT, onSignal);
+		signal(SIGTERM, onSignal);
+
+		server.run();
+
+		g_pServer = nullptr;
+	} catch (const invalid_argument& ex) {
+		cout << ex.what() << endl;
+		return -1;
+	} catch (const runtime_error& ex) {
+		cout << ex.what() << endl;
+		return -1;
+	}
+	return 0;
+}
+
+// iniparser --query <socket> <section.key...> - prints the values, one per line
+static int query(const string& strSocketPath, const vector<string>& keys) {
+
+	int nReturn = 0;
+	try {
+		IniClient client(strSocketPath);
+
+		vector<IniClient::Answer> answers;
+		client.query(keys, answers);
+
+		for (size_t i = 0; i < keys.size(); i++) {
+			if (answers[i].bFound) {
+				cout << answers[i].strValue << '\n';
+			} else {
+				cout << '\n';
+				cerr << "No such key: " << keys[i] << endl;
+				nReturn = -1;
+			}
+		}
+	} catch (const invalid_argument& ex) {
+		cout << ex.what() << endl;
+		return -1;
+	} catch (const runtime_error& ex) {
+		cout << ex.what() << endl;
+		return -1;
+	}
+	return nReturn;
+}
+
+// iniparser --publish <name> <files...> - loads the files and publishes them into shared memory, running it again republishes
+static int publish(const string& strName, const vector<string>& files) {
+
+	try {
+		IniParser parser(true);
+		for (const string& strFileName : files)
+			parser.updateFromFile(strFileName);
+		parser.freeze();
+
+		IniSharedPublisher publisher(strName);
+		publisher.publish(parser);
+	} catch (const invalid_argument& ex) {
+		cout << ex.what() << endl;
+		return -1;
+	} catch (const IniParser::invalid_format_exception& ex) {
+		cout << ex.what() << endl;
+		return -1;
+	} catch (const runtime_error& ex) {
+		cout << ex.what() << endl;
+		return -1;
+	}
+	return 0;
+}
+
 int main(int argc, char* args[]) {
 
+	if (argc >= 3 && (strcmp(args[1], "--serve") == 0 || strcmp(args[1], "--query") == 0)) {
+		vector<string> arguments(args + 3, args + argc);
+		return strcmp(args[1], "--serve") == 0 ? serve(args[2], arguments) : query(args[2], arguments);
+	}
+
+	if (argc >= 3 && strcmp(args[1], "--publish") == 0)
+		return publish(args[2], vector<string>(args + 3, args + argc));
+
 	IniParser parser(true);
 
 	for (auto i = 1; i < argc; i++) {
@@ -20,6 +20,15 @@ private: // unit tests
     bool testKeyValueAssigmentsUpdate();
     bool testNoSuchKeyException();
     bool testInvalidFormatException();
+    bool testFreeze();
+    bool testGzipFile();
+    bool testStringPool();
+    bool testLoadFilter();
+    bool testDiffApply();
+    bool testServer();
+    bool testStrongGuarantee();
+    bool testWriter();
+    bool testSharedMemory();
     bool testClear();
 
 private: // atributes
@@ -1,7 +1,20 @@
 #include <iostream>
+#include <fstream>
+#include <cstdio>
+#include <thread>
+#include <chrono>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/un.h>
 #include <assert.h>
 
 #include "IniParserTestSuite.h"
+#include "IniServer.h"
+#include "IniClient.h"
+#include "IniSharedPublisher.h"
+#include "IniSharedReader.h"
 
 #include "IniParserT.cpp" // it needs to include template specialisations... 
 
@@ -30,6 +43,15 @@ bool IniParserTestSuite::runTests() {
     bReturn = bReturn && testKeyValueAssigmentsUpdate();
     bReturn = bReturn && testNoSuchKeyException();
     bReturn = bReturn && testInvalidFormatException();
+    bReturn = bReturn && testFreeze();
+    bReturn = bReturn && testGzipFile();
+    bReturn = bReturn && testStringPool();
+    bReturn = bReturn && testLoadFilter();
+    bReturn = bReturn && testDiffApply();
+    bReturn = bReturn && testServer();
+    bReturn = bReturn && testStrongGuarantee();
+    bReturn = bReturn && testWriter();
+    bReturn = bReturn && testSharedMemory();
     bReturn = bReturn && testClear();
 
     return bReturn;
@@ -302,6 +324,636 @@ bool IniParserTestSuite::testInvalidFormatException() {
     return false;         
 }
 
+bool IniParserTestSuite::testFreeze() {
+    cout << "Testing the freeze operation...\n";
+
+    // work on a copy, the values loaded so far are needed by the next tests
+    IniParser parser(m_iniParser);
+    parser.freeze();
+
+    if (!parser.isFrozen() || parser.size() != m_iniParser.size()) {
+        cout << "[Failed]\n";
+        return false;
+    }
+
+    try {
+        if (parser.getValueT<string>("city", "details.about") != "bucharest"
+            || parser.getValueT<string>("company") != "eset"
+            || parser.getValueT<string>("key", "section") != "some string with spaces"
+            || parser.getValueT<string>("river") != ""
+            || parser.getValueT<int>("key") != 7
+            || !parser.getValueT<bool>("isNice", "details.about")) {
+            cout << "[Failed]\n";
+            return false;
+        }
+    } catch (const runtime_error& ex) {
+        cout << ex.what() << endl;
+        cout << "[Failed]\n";
+        return false;
+    }
+
+    // keys that hash into the table but are not there
+    try {
+        parser.getValueT<string>("city", "details");
+        cout << "[Failed]\n";
+        return false;
+    } catch (const IniParser::no_such_key_exception& ex) {
+        cout << ex.what() << endl;
+    }
+
+    // updates are rejected while frozen
+    try {
+        parser.updateFromFile(m_strUpdateFile);
+        cout << "[Failed]\n";
+        return false;
+    } catch (const logic_error& ex) {
+        cout << ex.what() << endl;
+    }
+
+    parser.unfreeze();
+    if (parser.isFrozen() || parser.size() != m_iniParser.size()
+        || parser.getValueT<string>("country", "details.about") != "romania") {
+        cout << "[Failed]\n";
+        return false;
+    }
+
+    // assigning a frozen parser replaces the values, none of the old ones come back when unfreezing
+    IniParser frozen(true);
+    frozen.setValue("only", "value");
+    frozen.freeze();
+    parser = frozen;
+    parser.unfreeze();
+    if (parser.size() != 1 || parser.getValueT<string>("only") != "value") {
+        cout << "[Failed]\n";
+        return false;
+    }
+
+    cout << "[Passed]\n";
+    return true;
+}
+
+bool IniParserTestSuite::testGzipFile() {
+    cout << "Testing the .INI parser with a gzip compressed file...\n";
+
+    // the compressed twin of the first file sits next to it
+    string strGzipFile = m_strFirstFile + ".gz";
+
+    IniParser plain(true);
+    IniParser compressed(true);
+    try {
+        if (0 != plain.updateFromFile(m_strFirstFile) || 0 != compressed.updateFromFile(strGzipFile)) {
+            cout << "[Failed]\n";
+            return false;
+        }
+
+        if (plain.size() != compressed.size()
+            || compressed.getValueT<string>("city", "details.about") != "bucharest"
+            || compressed.getValueT<string>("key", "section") != "some string with spaces"
+            || compressed.getValueT<int>("key") != 7) {
+            cout << "[Failed]\n";
+            return false;
+        }
+    } catch (const runtime_error& ex) {
+        cout << ex.what() << endl;
+        cout << "[Failed]\n";
+        return false;
+    }
+
+    // a truncated gzip file must be reported
+    string strTruncatedFile = strGzipFile + ".truncated";
+    {
+        ifstream ifs(strGzipFile, ifstream::binary);
+        string strBytes((istreambuf_iterator<char>(ifs)), istreambuf_iterator<char>());
+        ofstream ofs(strTruncatedFile, ofstream::binary);
+        ofs << strBytes.substr(0, strBytes.length() / 2);
+    }
+
+    bool bReturn = false;
+    try {
+        IniParser truncated(true);
+        truncated.updateFromFile(strTruncatedFile);
+    } catch (const runtime_error& ex) {
+        cout << ex.what() << endl;
+        bReturn = true;
+    }
+    remove(strTruncatedFile.c_str());
+
+    cout << (bReturn ? "[Passed]\n" : "[Failed]\n");
+    return bReturn;
+}
+
+bool IniParserTestSuite::testStringPool() {
+    cout << "Testing the shared string pool...\n";
+
+    shared_ptr<IniStringPool> stringPool = IniStringPool::create();
+    {
+        IniParser first(true);
+        first.setStringPool(stringPool);
+        first.updateFromFile(m_strFirstFile);
+        size_t nPooled = stringPool->size();
+
+        // a second parser loading the same file adds nothing to the pool
+        IniParser second(true);
+        second.updateFromFile(m_strFirstFile);
+        second.setStringPool(stringPool);
+
+        if (nPooled == 0 || stringPool->size() != nPooled
+            || second.getValueT<string>("city", "details.about") != "bucharest") {
+            cout << "[Failed]\n";
+            return false;
+        }
+
+        // strings still used by the second parser stay in the pool
+        first.clear();
+        if (stringPool->size() != nPooled) {
+            cout << "[Failed]\n";
+            return false;
+        }
+    }
+
+    // strings leave the pool with their last parser
+    if (stringPool->size() != 0) {
+        cout << "[Failed]\n";
+        return false;
+    }
+
+    cout << "[Passed]\n";
+    return true;
+}
+
+bool IniParserTestSuite::testLoadFilter() {
+    cout << "Testing the load filter...\n";
+
+    try {
+        // whole sections
+        IniParser sections(true);
+        sections.setLoadFilter(IniLoadFilter().addSection("details.about"));
+        sections.updateFromFile(m_strFirstFile);
+        sections.updateFromFile(m_strUpdateFile);
+
+        if (sections.size() != 5
+            || sections.getValueT<string>("city", "details.about") != "bucharest"
+            || !sections.getValueT<bool>("isNice", "details.about")) {
+            cout << "[Failed]\n";
+            return false;
+        }
+
+        // key prefixes, both inside and outside sections
+        IniParser prefixes(true);
+        prefixes.setLoadFilter(IniLoadFilter().addKeyPrefix("section.").addKeyPrefix("ri"));
+        prefixes.updateFromFile(m_strFirstFile);
+
+        if (prefixes.size() != 2
+            || prefixes.getValueT<string>("key", "section") != "some string with spaces"
+            || prefixes.getValueT<string>("river") != "") {
+            cout << "[Failed]\n";
+            return false;
+        }
+
+        // section predicate
+        IniParser predicate(true);
+        predicate.setLoadFilter(IniLoadFilter().setSectionPredicate([](const string& strSection) {
+            return strSection.empty();
+        }));
+        predicate.updateFromFile(m_strFirstFile);
+
+        if (predicate.size() != 3 || predicate.getValueT<int>("key") != 7) {
+            cout << "[Failed]\n";
+            return false;
+        }
+    } catch (const runtime_error& ex) {
+        cout << ex.what() << endl;
+        cout << "[Failed]\n";
+        return false;
+    }
+
+    cout << "[Passed]\n";
+    return true;
+}
+
+bool IniParserTestSuite::testDiffApply() {
+    cout << "Testing the diff and apply operations...\n";
+
+    try {
+        IniParser first(true);
+        first.updateFromFile(m_strFirstFile);
+
+        // the update file adds 'company' and changes 'details.about.isNice'
+        IniParser::change_set changes = IniParser::diff(first, m_iniParser);
+        if (changes.size() != 2
+            || changes[0].type != IniParser::change::added || changes[0].key.str() != "company"
+            || changes[1].type != IniParser::change::changed || changes[1].key.str() != "details.about.isNice"
+            || changes[1].value.str() != "true") {
+            cout << "[Failed]\n";
+            return false;
+        }
+
+        // going back removes 'company'
+        IniParser::change_set reverted = IniParser::diff(m_iniParser, first);
+        if (reverted.size() != 2 || reverted[0].type != IniParser::change::removed) {
+            cout << "[Failed]\n";
+            return false;
+        }
+
+        // applying the changes catches up with the updated parser
+        first.apply(changes);
+        if (first.size() != m_iniParser.size() || !IniParser::diff(first, m_iniParser).empty()
+            || first.getValueT<string>("company") != "eset") {
+            cout << "[Failed]\n";
+            return false;
+        }
+
+        first.apply(reverted);
+        if (first.size() != m_iniParser.size() - 1 || first.getValueT<bool>("isNice", "details.about")) {
+            cout << "[Failed]\n";
+            return false;
+        }
+
+        // changes out of order and repeated keys are applied in order too
+        IniParser::change_set unsorted = {
+            IniParser::change{ IniParser::change::changed, IniString("river"), IniString("danube") },
+            IniParser::change{ IniParser::change::removed, IniString("key") },
+            IniParser::change{ IniParser::change::added, IniString("company"), IniString("other") },
+            IniParser::change{ IniParser::change::changed, IniString("river"), IniString("olt") }
+        };
+        first.apply(unsorted);
+        if (first.size() != m_iniParser.size() - 1 || first.getValueT<string>("river") != "olt"
+            || first.getValueT<string>("company") != "other") {
+            cout << "[Failed]\n";
+            return false;
+        }
+        try {
+            first.getValueT<string>("key");
+            cout << "[Failed]\n";
+            return false;
+        } catch (const IniParser::no_such_key_exception& ex) {
+        }
+    } catch (const exception& ex) {
+        cout << ex.what() << endl;
+        cout << "[Failed]\n";
+        return false;
+    }
+
+    cout << "[Passed]\n";
+    return true;
+}
+
+bool IniParserTestSuite::testServer() {
+    cout << "Testing the query server with a local client...\n";
+
+    string strSocketPath = "/tmp/test-iniparser-" + to_string(getpid()) + ".sock";
+
+    // long keys and values, so the requests and the answers of a batch overflow the socket buffers
+    string strLongFile = m_strUpdateFile + ".long";
+    {
+        ofstream ofs(strLongFile);
+        ofs << "[long]\n";
+        for (int i = 0; i < 8; i++)
+            ofs << "k" << i << string(2000, 'k') << " = " << string(2000, 'a' + i) << '\n';
+    }
+
+    try {
+        IniServer server(strSocketPath, { m_strFirstFile, m_strUpdateFile, strLongFile });
+        thread serverThread(&IniServer::run, &server);
+
+        bool bReturn = true;
+        try {
+            // load test: batches of pipelined queries, a missing key every 4 queries
+            const size_t nBatches = 200;
+            const string keys[] = { "details.about.city", "company", "section.key", "details.about.nothing" };
+            vector<string> batch;
+            for (size_t i = 0; i < 1000; i++)
+                batch.push_back(keys[i % 4]);
+
+            IniClient client(strSocketPath);
+            vector<IniClient::Answer> answers;
+
+            auto start = chrono::steady_clock::now();
+            for (size_t i = 0; i < nBatches && bReturn; i++) {
+                client.query(batch, answers);
+                for (size_t j = 0; j < answers.size(); j += 4) {
+                    bReturn = bReturn
+                        && answers[j].bFound && answers[j].strValue == "bucharest"
+                        && answers[j + 1].bFound && answers[j + 1].strValue == "eset"
+                        && answers[j + 2].bFound && answers[j + 2].strValue == "some string with spaces"
+                        && !answers[j + 3].bFound;
+                }
+            }
+            auto elapsed = chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start);
+            cout << nBatches * batch.size() << " queries in " << elapsed.count() << " us\n";
+
+            // a single query on a fresh connection, as the command line client does
+            start = chrono::steady_clock::now();
+            IniClient single(strSocketPath);
+            single.query({ "details.about.isNice" }, answers);
+            elapsed = chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start);
+            cout << "single query in " << elapsed.count() << " us\n";
+
+            bReturn = bReturn && answers.size() == 1 && answers[0].strValue == "true";
+
+            // the answers survive a reload
+            server.reload();
+            single.query({ "company" }, answers);
+            bReturn = bReturn && answers[0].bFound && answers[0].strValue == "eset";
+
+            // a live server's socket is not taken over
+            try {
+                IniServer second(strSocketPath, { m_strFirstFile });
+                bReturn = false;
+            } catch (const runtime_error& ex) {
+                cout << ex.what() << endl;
+            }
+
+            // neither is a file that is not a socket
+            try {
+                IniServer overFile(strLongFile, { m_strFirstFile });
+                bReturn = false;
+            } catch (const runtime_error& ex) {
+                cout << ex.what() << endl;
+            }
+            ifstream ifsLong(strLongFile);
+            bReturn = bReturn && ifsLong.good();
+
+            // a batch of long requests answered while it is still being sent
+            vector<string> longBatch;
+            for (size_t i = 0; i < 1024; i++)
+                longBatch.push_back("long.k" + to_string(i % 8) + string(2000, 'k'));
+            client.query(longBatch, answers);
+            for (size_t i = 0; i < answers.size(); i++)
+                bReturn = bReturn && answers[i].bFound && answers[i].strValue == string(2000, 'a' + i % 8);
+            bReturn = bReturn && answers.size() == longBatch.size();
+        } catch (const exception& ex) {
+            cout << ex.what() << endl;
+            bReturn = false;
+        }
+
+        server.stop();
+        serverThread.join();
+        remove(strLongFile.c_str());
+
+        if (!bReturn) {
+            cout << "[Failed]\n";
+            return false;
+        }
+    } catch (const exception& ex) {
+        cout << ex.what() << endl;
+        cout << "[Failed]\n";
+        remove(strLongFile.c_str());
+        return false;
+    }
+
+    // the socket of a server that is gone is replaced
+    try {
+        int nStale = socket(AF_UNIX, SOCK_STREAM, 0);
+        sockaddr_un address = {};
+        address.sun_family = AF_UNIX;
+        strncpy(address.sun_path, strSocketPath.c_str(), sizeof(address.sun_path) - 1);
+        int nResult = bind(nStale, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+        close(nStale);
+
+        IniServer restarted(strSocketPath, { m_strFirstFile });
+        if (nResult != 0) {
+            cout << "[Failed]\n";
+            return false;
+        }
+    } catch (const exception& ex) {
+        cout << ex.what() << endl;
+        cout << "[Failed]\n";
+        return false;
+    }
+
+    cout << "[Passed]\n";
+    return true;
+}
+
+bool IniParserTestSuite::testStrongGuarantee() {
+    cout << "Testing that a failed load leaves the values untouched...\n";
+
+    // valid assigments followed by an invalid line
+    string strInvalidFile = m_strUpdateFile + ".invalid";
+    {
+        ofstream ofs(strInvalidFile);
+        ofs << "company = other\nnew = value\n[details.about]\nisNice = false\nthis is an invalid line\n";
+    }
+
+    bool bReturn = false;
+    IniParser parser(false);
+    try {
+        parser.updateFromFile(m_strUpdateFile);
+        parser.updateFromFile(strInvalidFile);
+    } catch (const IniParser::invalid_format_exception& ex) {
+        cout << ex.what() << endl;
+        bReturn = parser.size() == 2
+            && parser.getValueT<string>("company") == "eset"
+            && parser.getValueT<bool>("isNice", "details.about");
+    }
+    remove(strInvalidFile.c_str());
+
+    cout << (bReturn ? "[Passed]\n" : "[Failed]\n");
+    return bReturn;
+}
+
+bool IniParserTestSuite::testWriter() {
+    cout << "Testing the edits written back into the source file...\n";
+
+    string strEditedFile = m_strFirstFile + ".edited";
+    string strWrittenFile = m_strFirstFile + ".written";
+    {
+        ifstream ifs(m_strFirstFile, ios::binary);
+        ofstream ofs(strEditedFile, ios::binary);
+        ofs << ifs.rdbuf();
+
+        // a file named like a temporary file must survive the write
+        ofstream ofsTemp(strEditedFile + ".tmp");
+        ofsTemp << "untouched";
+    }
+    chmod(strEditedFile.c_str(), 0640);
+
+    bool bReturn = false;
+    try {
+        IniParser parser(true);
+        parser.updateFromFile(strEditedFile);
+
+        parser.setValue("city", "cluj", "details.about");
+        parser.setValue("lake", " sea ");
+        parser.setValue("extra", "yes", "section");
+        parser.setValue("port", "8080", "server");
+        parser.removeKey("lastname", "details.about");
+        parser.writeToFile(strEditedFile, strEditedFile);
+
+        // comments and invalid lines are kept as they were
+        ifstream ifs(strEditedFile, ios::binary);
+        string strContent((istreambuf_iterator<char>(ifs)), istreambuf_iterator<char>());
+        bool bLayout = strContent.find("; this is a comment\n    ; [this is still a comment]\n") == 0
+            && strContent.find("i n va li d line\n") != string::npos
+            && strContent.find(" city = cluj\n") != string::npos
+            && strContent.find("\nlastname") == string::npos
+            && strContent.find("key = some string with spaces\nextra = yes\n") != string::npos
+            && strContent.find("isNice = false\n\n[server]\nport = 8080\n") != string::npos;
+
+        IniParser reloaded(true);
+        reloaded.updateFromFile(strEditedFile);
+
+        // the edited file keeps its permissions
+        struct stat status;
+        ifstream ifsTemp(strEditedFile + ".tmp");
+        string strTemp((istreambuf_iterator<char>(ifsTemp)), istreambuf_iterator<char>());
+        bLayout = bLayout && stat(strEditedFile.c_str(), &status) == 0 && (status.st_mode & 07777) == 0640
+            && strTemp == "untouched";
+
+        // everything loads back the same, also from a file written from scratch
+        IniParser written(true);
+        parser.writeToFile(strWrittenFile);
+        written.updateFromFile(strWrittenFile);
+
+        // long values are written from the parser's memory, more pieces than a single writev takes
+        IniParser many(true);
+        for (int i = 0; i < 2000; i++)
+            many.setValue("k" + to_string(i), string(600, 'a' + i % 26), "s");
+        many.writeToFile(strWrittenFile);
+        IniParser manyReloaded(true);
+        manyReloaded.updateFromFile(strWrittenFile);
+
+        // lines ending with a carriage return don't load, so the edit goes in as a new line
+        {
+            ofstream ofs(strWrittenFile, ios::binary);
+            ofs << "[a]\r\nx = 1\r\ny = 2\n";
+        }
+        IniParser crlf(true);
+        crlf.updateFromFile(strWrittenFile);
+        crlf.setValue("x", "10", "a");
+        crlf.setValue("y", "20", "a");
+        crlf.writeToFile(strWrittenFile, strWrittenFile);
+        IniParser crlfReloaded(true);
+        crlfReloaded.updateFromFile(strWrittenFile);
+        ifstream ifsCrlf(strWrittenFile, ios::binary);
+        string strCrlf((istreambuf_iterator<char>(ifsCrlf)), istreambuf_iterator<char>());
+
+        // a file without keys outside sections starts with the first section
+        IniParser sectioned(true);
+        sectioned.setValue("x", "1", "a");
+        sectioned.setValue("y", "2", "a");
+        sectioned.writeToFile(strWrittenFile);
+        ifstream ifsSectioned(strWrittenFile, ios::binary);
+        string strSectioned((istreambuf_iterator<char>(ifsSectioned)), istreambuf_iterator<char>());
+
+        bReturn = bLayout
+            && IniParser::diff(parser, reloaded).empty()
+            && IniParser::diff(parser, written).empty()
+            && IniParser::diff(many, manyReloaded).empty()
+            && strSectioned == "[a]\nx = 1\ny = 2\n"
+            && IniParser::diff(crlf, crlfReloaded).empty()
+            && strCrlf == "[a]\r\nx = 1\r\ny = 20\nx = 10\n"
+            && reloaded.getValueT<string>("lake") == "sea"
+            && !parser.removeKey("lastname", "details.about");
+    } catch (const exception& ex) {
+        cout << ex.what() << endl;
+    }
+    remove(strEditedFile.c_str());
+    remove((strEditedFile + ".tmp").c_str());
+    remove(strWrittenFile.c_str());
+
+    cout << (bReturn ? "[Passed]\n" : "[Failed]\n");
+    return bReturn;
+}
+
+// looks the published keys up until the last generation shows up
+// every value names the generation it was published in, so a value from another generation is caught
+static bool readShared(const string& strName, uint32_t nLastGeneration, int nKeys) {
+
+    try {
+        IniSharedReader reader(strName);
+
+        uint32_t nSeen = 0;
+        string strValue;
+        auto deadline = chrono::steady_clock::now() + chrono::seconds(30);
+        while (chrono::steady_clock::now() < deadline) {
+            for (int k = 0; k < nKeys; k++) {
+                if (!reader.find("key" + to_string(k), "stress", strValue))
+                    return false;
+                if (strValue != to_string(reader.generation()) + "." + to_string(k) || reader.generation() < nSeen)
+                    return false;
+                nSeen = reader.generation();
+            }
+
+            if (!reader.find("city", "details.about", strValue) || strValue != "bucharest" || reader.find("missing", "", strValue))
+                return false;
+            if (nSeen == nLastGeneration)
+                return true;
+        }
+    } catch (const exception& ex) {
+        cerr << ex.what() << endl;
+    }
+    return false;
+}
+
+bool IniParserTestSuite::testSharedMemory() {
+    cout << "Testing lookups from shared memory in several processes while it is republished...\n";
+
+    const int nWorkers = 4;
+    const int nKeys = 100;
+    const uint32_t nGenerations = 500;
+    string strName = "/test-iniparser-" + to_string(getpid());
+
+    bool bReturn = true;
+    try {
+        IniSharedPublisher publisher(strName);
+
+        IniParser parser(true);
+        parser.updateFromFile(m_strFirstFile);
+        for (int k = 0; k < nKeys; k++)
+            parser.setValue("key" + to_string(k), "1." + to_string(k), "stress");
+        publisher.publish(parser);
+
+        vector<pid_t> workers;
+        cout.flush();
+        for (int w = 0; w < nWorkers; w++) {
+            pid_t pid = fork();
+            if (pid == 0)
+                _exit(readShared(strName, nGenerations, nKeys) ? 0 : 1);
+            if (pid > 0)
+                workers.push_back(pid);
+        }
+
+        // republish while the workers read, every other generation from a frozen parser
+        for (uint32_t g = 2; g <= nGenerations; g++) {
+            for (int k = 0; k < nKeys; k++)
+                parser.setValue("key" + to_string(k), to_string(g) + "." + to_string(k), "stress");
+
+            if (g % 2) {
+                parser.freeze();
+                publisher.publish(parser);
+                parser.unfreeze();
+            } else {
+                publisher.publish(parser);
+            }
+        }
+
+        for (pid_t pid : workers) {
+            int nStatus = 0;
+            bReturn = waitpid(pid, &nStatus, 0) == pid && WIFEXITED(nStatus) && WEXITSTATUS(nStatus) == 0 && bReturn;
+        }
+        bReturn = bReturn && workers.size() == nWorkers && publisher.generation() == nGenerations;
+
+        // readers attached before the removal keep their values, new ones cannot attach
+        IniSharedReader reader(strName);
+        publisher.unlink();
+
+        string strValue;
+        bReturn = bReturn && reader.find("key7", "stress", strValue) && strValue == to_string(nGenerations) + ".7";
+        try {
+            IniSharedReader late(strName);
+            bReturn = false;
+        } catch (const runtime_error& ex) {
+        }
+    } catch (const exception& ex) {
+        cout << ex.what() << endl;
+        bReturn = false;
+    }
+
+    cout << (bReturn ? "[Passed]\n" : "[Failed]\n");
+    return bReturn;
+}
 
 bool IniParserTestSuite::testClear() {
     cout << "Testing the clear operation...\n";